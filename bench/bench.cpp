@@ -0,0 +1,267 @@
+// bench.cpp — 📊 микробенчмарки движка на синтетических моделях, результат в JSON
+//
+//   3d-script-engine-bench [--points 1000,100000,1000000] [--iterations 5] [--size 1280x720]
+//                          [--dir /tmp/3dse-bench] [--keep] [--out results.json]
+//   3d-script-engine-bench --generate model.json 1000000   # только сгенерировать модель
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "json.hpp"
+
+#include "core.hpp"
+#include "mesh.hpp"
+#include "mesh_cache.hpp"
+#include "projection.hpp"
+#include "scene_generator.hpp"
+#include "thread_pool.hpp"
+
+#ifndef ENGINE_BUILD_TYPE
+#define ENGINE_BUILD_TYPE ""
+#endif
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+App app;
+
+// 🤫 Загрузчик и запекание печатают отладку в std::cout — на время замеров она уходит в никуда,
+// чтобы в stdout остался только JSON
+class QuietStdout {
+public:
+    QuietStdout() : saved(std::cout.rdbuf(sink.rdbuf())) {}
+    ~QuietStdout() { std::cout.rdbuf(saved); }
+
+private:
+    std::ostringstream sink;
+    std::streambuf* saved;
+};
+
+struct BenchSettings {
+    std::vector<uint64_t> pointCounts = { 1000, 100000, 1000000 };
+    int iterations = 5;
+    int width = 1280, height = 720;
+    fs::path dir = fs::temp_directory_path() / "3dse-bench";
+    bool keep = false;
+};
+
+// ⏱️ Один прогрев, затем iterations замеров; в отчёт — min/median/mean/max в миллисекундах
+static json measure(const std::string& name, uint64_t points, int iterations, const std::function<void()>& fn) {
+    using clock = std::chrono::steady_clock;
+
+    fn();
+    std::vector<double> ms;
+    ms.reserve(size_t(iterations));
+    for (int i = 0; i < iterations; ++i) {
+        auto start = clock::now();
+        fn();
+        ms.push_back(std::chrono::duration<double, std::milli>(clock::now() - start).count());
+    }
+    std::sort(ms.begin(), ms.end());
+
+    double sum = 0.0;
+    for (double v : ms) sum += v;
+    double median = ms.size() % 2 ? ms[ms.size() / 2] : 0.5 * (ms[ms.size() / 2 - 1] + ms[ms.size() / 2]);
+
+    json result = {
+        { "name", name },
+        { "points", points },
+        { "iterations", iterations },
+        { "min_ms", ms.front() },
+        { "median_ms", median },
+        { "mean_ms", sum / double(ms.size()) },
+        { "max_ms", ms.back() },
+    };
+    if (points > 0 && median > 0.0)
+        result["points_per_second"] = double(points) / (median / 1000.0);
+
+    std::cerr << "  " << name << " (" << points << " points): " << median << " ms\n";
+    return result;
+}
+
+static void renderFrame(const Mesh& mesh) {
+    app.clear(app.frame);
+    app.beginFrame();
+    app.drawMesh(mesh);
+    app.endFrame(app.frame);
+}
+
+static void benchScene(const BenchSettings& settings, uint64_t pointCount, json& results) {
+    SceneSpec spec;
+    spec.pointCount = pointCount;
+    fs::path jsonPath = settings.dir / ("synthetic_" + std::to_string(pointCount) + ".json");
+    std::string path = jsonPath.string();
+    std::string cachePath = meshCachePath(path);
+
+    std::cerr << "Scene: " << pointCount << " points\n";
+
+    // 🧪 Генерация — один раз, но тоже в отчёт (полезно следить за скоростью записи)
+    {
+        auto start = std::chrono::steady_clock::now();
+        if (!generateSceneJson(path, spec)) {
+            std::cerr << "Failed to generate " << path << '\n';
+            return;
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        results.push_back({ { "name", "generate" }, { "points", pointCount }, { "iterations", 1 },
+                            { "min_ms", ms }, { "median_ms", ms }, { "mean_ms", ms }, { "max_ms", ms },
+                            { "bytes", uint64_t(fs::file_size(jsonPath)) } });
+    }
+
+    // 📦 Загрузка: разбор JSON и готовый кэш (mmap)
+    {
+        QuietStdout quiet;
+        app.useMeshCache = false;
+        results.push_back(measure("loader.json", pointCount, settings.iterations, [&] { app.loader(path); }));
+
+        app.bake(path);
+        results.push_back(measure("loader.cache", pointCount, settings.iterations, [&] { app.loader(cachePath); }));
+    }
+
+    Mesh mesh;
+    {
+        QuietStdout quiet;
+        mesh = app.loader(cachePath);
+    }
+
+    // 🎥 Камера смотрит на куб сцены целиком
+    float extent = sceneExtent(spec);
+    cam = Camera();
+    cam.z = -1.5f * extent;
+    app.clear(app.frame);
+    app.beginFrame();
+
+    // 🎯 Проекция: по одной точке (draw3DPoint) и пачкой (projectPoints)
+    results.push_back(measure("draw3DPoint", pointCount, settings.iterations, [&] {
+        for (size_t i = 0; i < mesh.pointCount(); ++i)
+            app.draw3DPoint(app.frame, mesh.point(i));
+    }));
+
+    ProjectedPoints projected;
+    projected.resize(mesh.pointCount());
+    results.push_back(measure("projectPoints", pointCount, settings.iterations, [&] {
+        projectPoints(app.view, mesh.x.data(), mesh.y.data(), mesh.z.data(), mesh.pointCount(),
+                      projected.x.data(), projected.y.data(), projected.depth.data(), projected.visible.data());
+    }));
+
+    // 🖼️ Целый кадр: очистка, матрица, отсечение, проекция, растеризация
+    app.raster.settings = RasterSettings();
+    results.push_back(measure("frame.wireframe", pointCount, settings.iterations, [&] { renderFrame(mesh); }));
+
+    app.raster.settings.filled = true;
+    results.push_back(measure("frame.filled", pointCount, settings.iterations, [&] { renderFrame(mesh); }));
+    app.raster.settings = RasterSettings();
+
+    mesh = Mesh(); // 🗺️ отпускаем отображение кэша до удаления файла
+    if (!settings.keep) {
+        std::error_code ec;
+        fs::remove(jsonPath, ec);
+        fs::remove(cachePath, ec);
+    }
+}
+
+static bool parsePointList(const std::string& text, std::vector<uint64_t>& out) {
+    out.clear();
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        char* end = nullptr;
+        double value = std::strtod(item.c_str(), &end); // 🔹 понимает и 1e8
+        if (end == item.c_str() || value < 1) return false;
+        out.push_back(uint64_t(value));
+    }
+    return !out.empty();
+}
+
+int main(int argc, char** argv) {
+    BenchSettings settings;
+    std::string outPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--points" && i + 1 < argc) {
+            if (!parsePointList(argv[++i], settings.pointCounts)) {
+                std::cerr << "Bad --points, expected N[,N...]\n";
+                return 1;
+            }
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            settings.iterations = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--size" && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &settings.width, &settings.height) != 2) {
+                std::cerr << "Bad --size, expected WxH\n";
+                return 1;
+            }
+        } else if (arg == "--dir" && i + 1 < argc) {
+            settings.dir = argv[++i];
+        } else if (arg == "--keep") {
+            settings.keep = true;
+        } else if (arg == "--out" && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (arg == "--generate" && i + 2 < argc) {
+            // 🧪 Режим генератора: модель в файл и выход
+            SceneSpec spec;
+            std::string path = argv[++i];
+            std::vector<uint64_t> count;
+            if (!parsePointList(argv[++i], count)) {
+                std::cerr << "Bad point count\n";
+                return 1;
+            }
+            spec.pointCount = count[0];
+            if (!generateSceneJson(path, spec)) {
+                std::cerr << "Failed to write " << path << '\n';
+                return 1;
+            }
+            return 0;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--points N[,N...]] [--iterations N] [--size WxH] [--dir path] [--keep] [--out file.json]\n"
+                      << "       " << argv[0] << " --generate model.json N\n";
+            return 1;
+        }
+    }
+
+    std::error_code ec;
+    fs::create_directories(settings.dir, ec);
+
+    windowWidth = settings.width;
+    windowHeight = settings.height;
+    app.setDPI(96);
+
+    json results = json::array();
+
+    // 🧹 Очистка кадра от модели не зависит — меряется один раз
+    results.push_back(measure("clear", 0, settings.iterations, [&] { app.clear(app.frame); }));
+
+    for (uint64_t count : settings.pointCounts)
+        benchScene(settings, count, results);
+
+    json report = {
+        { "version", 1 },
+        { "buildType", ENGINE_BUILD_TYPE }, // 🔹 сравнивать имеет смысл только одинаковые сборки
+        { "width", settings.width },
+        { "height", settings.height },
+        { "threads", threadPool().size() },
+        { "projectionKernel", projectionKernelName() },
+        { "results", results },
+    };
+
+    std::string text = report.dump(2);
+    if (outPath.empty()) {
+        std::cout << text << '\n';
+    } else {
+        std::ofstream out(outPath);
+        out << text << '\n';
+        if (!out) {
+            std::cerr << "Failed to write " << outPath << '\n';
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+// scene_generator.cpp
+#include "scene_generator.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// 🎲 SplitMix64 — быстрый и одинаковый на всех платформах (std::mt19937 + distribution — нет)
+static uint64_t nextRandom(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static float randomUnit(uint64_t& state) {
+    return float(nextRandom(state) >> 40) / float(1u << 24); // [0, 1)
+}
+
+float sceneExtent(const SceneSpec& spec) {
+    if (spec.extent > 0.0f) return spec.extent;
+    // 🔹 Примерно 10 см между соседними полигонами при любом числе точек
+    double polygons = std::max<double>(1.0, double(spec.pointCount) / std::max(1u, spec.pointsPerPolygon));
+    return float(std::max(100.0, 10.0 * std::cbrt(polygons)));
+}
+
+// 🧺 Буферизованный вывод: числа форматируются через to_chars, без printf на каждую точку
+class JsonWriter {
+public:
+    explicit JsonWriter(FILE* file) : file(file) { buffer.reserve(CAPACITY); }
+    ~JsonWriter() { flush(); }
+
+    void raw(const char* s) { raw(s, std::strlen(s)); }
+    void raw(const char* s, size_t n) {
+        if (buffer.size() + n > CAPACITY) flush();
+        buffer.insert(buffer.end(), s, s + n);
+    }
+    void number(float v) {
+        char tmp[32];
+        auto result = std::to_chars(tmp, tmp + sizeof(tmp), v);
+        raw(tmp, size_t(result.ptr - tmp));
+    }
+    void integer(unsigned v) {
+        char tmp[16];
+        auto result = std::to_chars(tmp, tmp + sizeof(tmp), v);
+        raw(tmp, size_t(result.ptr - tmp));
+    }
+    void flush() {
+        if (!buffer.empty() && std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) failed = true;
+        buffer.clear();
+    }
+    bool ok() const { return !failed; }
+
+private:
+    static const size_t CAPACITY = 1 << 20;
+    FILE* file;
+    std::vector<char> buffer;
+    bool failed = false;
+};
+
+bool generateSceneJson(const std::string& path, const SceneSpec& spec) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+
+    const float extent = sceneExtent(spec);
+    const uint32_t perPolygon = std::max(1u, spec.pointsPerPolygon);
+    const float size = std::max(1.0f, extent / 100.0f) * 5.0f; // радиус полигона
+    uint64_t state = spec.seed;
+
+    bool ok;
+    {
+        JsonWriter out(file);
+        out.raw("{\n  \"modelName\": \"synthetic\",\n  \"castShadow\": false,\n  \"polygons\": [\n");
+
+        uint64_t written = 0;
+        bool firstPolygon = true;
+        while (written < spec.pointCount) {
+            uint32_t count = uint32_t(std::min<uint64_t>(perPolygon, spec.pointCount - written));
+
+            float cx = (randomUnit(state) - 0.5f) * extent;
+            float cy = (randomUnit(state) - 0.5f) * extent;
+            float cz = (randomUnit(state) - 0.5f) * extent;
+            unsigned r = unsigned(nextRandom(state) & 0xFF), g = unsigned(nextRandom(state) & 0xFF), b = unsigned(nextRandom(state) & 0xFF);
+
+            out.raw(firstPolygon ? "    {" : ",\n    {");
+            firstPolygon = false;
+            out.raw("\"roughness\": 0.5, \"metallic\": 0.0, \"lightTarget\": \"none\", \"lightType\": \"normal\", \"lines\": [{\"points\": [");
+
+            for (uint32_t i = 0; i < count; ++i) {
+                // 🔹 Точки по окружности; последняя замыкает линию в первую
+                uint32_t k = (count > 2 && i == count - 1) ? 0 : i;
+                float angle = 6.2831853f * float(k) / float(std::max(1u, count > 2 ? count - 1 : count));
+                out.raw(i == 0 ? "{\"x\": " : ", {\"x\": ");
+                out.number(cx + size * std::cos(angle));
+                out.raw(", \"y\": ");
+                out.number(cy + size * std::sin(angle));
+                out.raw(", \"z\": ");
+                out.number(cz + size * 0.5f * std::sin(angle * 2.0f));
+                out.raw(", \"r\": ");
+                out.integer(r);
+                out.raw(", \"g\": ");
+                out.integer(g);
+                out.raw(", \"b\": ");
+                out.integer(b);
+                out.raw(", \"opacity\": 1.0, \"lightIntensity\": 0.0}");
+            }
+            out.raw("]}]}");
+            written += count;
+        }
+        out.raw("\n  ]\n}\n");
+        out.flush();
+        ok = out.ok();
+    }
+    return std::fclose(file) == 0 && ok;
+}
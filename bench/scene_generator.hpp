@@ -0,0 +1,20 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 🧪 Синтетические модели в формате cube.json — для бенчмарков.
+// Полигоны — замкнутые линии из pointsPerPolygon точек, разбросанные в кубе со стороной extent (в см)
+// вокруг начала координат. Один и тот же seed всегда даёт один и тот же файл.
+struct SceneSpec {
+    uint64_t pointCount = 1000;
+    uint32_t pointsPerPolygon = 4;  // ≥ 1; последняя точка линии совпадает с первой (замыкание)
+    uint64_t seed = 1;
+    float extent = 0.0f;            // 0 — по числу точек, чтобы плотность не зависела от размера
+};
+
+// 📐 Сторона куба сцены (если extent = 0 — подбирается по pointCount)
+float sceneExtent(const SceneSpec& spec);
+
+// ✍️ Записать модель потоком (память не зависит от числа точек). false — ошибка записи
+bool generateSceneJson(const std::string& path, const SceneSpec& spec);
@@ -0,0 +1,145 @@
+// animation.cpp
+#include "animation.hpp"
+#include "core.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// ───── Имена параметров ─────
+
+ParamId ParamTable::intern(const std::string& name) {
+    auto it = ids.find(name);
+    if (it != ids.end()) return it->second;
+
+    ParamId id = ParamId(names.size());
+    ids.emplace(name, id);
+    names.push_back(name);
+    return id;
+}
+
+ParamId ParamTable::find(const std::string& name) const {
+    auto it = ids.find(name);
+    return it == ids.end() ? INVALID_PARAM : it->second;
+}
+
+// ───── Загрузка ─────
+
+uint32_t AnimationSystem::compileClip(const std::string& name, const std::vector<Animation>& keys, bool loop) {
+    // 🔹 Раскладываем ключи по дорожкам параметров
+    struct Key { float time, value; };
+    std::vector<std::vector<Key>> perParam;
+    std::vector<ParamId> order; // параметры в порядке первого появления — дорожки клипа идут так же
+    float duration = 0.0f;
+
+    for (const Animation& key : keys) {
+        duration = std::max(duration, key.time);
+        for (const auto& [paramName, paramValue] : key.parameters) {
+            ParamId id = params.intern(paramName);
+            if (id >= perParam.size()) perParam.resize(id + 1);
+            if (perParam[id].empty()) order.push_back(id);
+            perParam[id].push_back({ key.time, paramValue });
+        }
+    }
+
+    Clip clip;
+    clip.name = name;
+    clip.trackBegin = uint32_t(tracks.size());
+    clip.trackCount = uint32_t(order.size());
+    clip.duration = duration;
+    clip.loop = loop;
+
+    for (ParamId id : order) {
+        auto& track = perParam[id];
+        std::stable_sort(track.begin(), track.end(), [](const Key& a, const Key& b) { return a.time < b.time; });
+
+        tracks.push_back({ id, uint32_t(keyTimes.size()), uint32_t(track.size()) });
+        for (const Key& k : track) {
+            keyTimes.push_back(k.time);
+            keyValues.push_back(k.value);
+        }
+    }
+
+    clips.push_back(std::move(clip));
+    restride();
+    return uint32_t(clips.size() - 1);
+}
+
+uint32_t AnimationSystem::findClip(const std::string& name) const {
+    for (size_t i = 0; i < clips.size(); ++i)
+        if (clips[i].name == name) return uint32_t(i);
+    return UINT32_MAX;
+}
+
+uint32_t AnimationSystem::addObject() {
+    restride();
+    values.resize((objects + 1) * stride, 0.0f);
+    return uint32_t(objects++);
+}
+
+void AnimationSystem::play(uint32_t object, uint32_t clip, float speed, float startTime) {
+    if (object >= objects || clip >= clips.size()) return;
+
+    players.push_back({ object, clip, uint32_t(cursors.size()), startTime, speed });
+    cursors.resize(cursors.size() + clips[clip].trackCount, 0);
+}
+
+void AnimationSystem::restride() {
+    size_t newStride = params.size();
+    if (newStride == stride) return;
+
+    // 📐 Переносим значения в более широкие строки — новые параметры начинаются с нуля
+    std::vector<float> wider(objects * newStride, 0.0f);
+    for (size_t o = 0; o < objects; ++o)
+        std::copy(values.begin() + o * stride, values.begin() + (o + 1) * stride, wider.begin() + o * newStride);
+    values.swap(wider);
+    stride = newStride;
+}
+
+// ───── Кадр ─────
+
+void AnimationSystem::update(float deltaTime) {
+    const float* times = keyTimes.data();
+    const float* vals = keyValues.data();
+
+    for (Player& player : players) {
+        const Clip& clip = clips[player.clip];
+
+        // ⏱️ Время проигрывания: по кругу или с упором в края
+        float t = player.time + deltaTime * player.speed;
+        if (clip.duration <= 0.0f) {
+            t = 0.0f;
+        } else if (clip.loop) {
+            t = std::fmod(t, clip.duration);
+            if (t < 0.0f) t += clip.duration;
+        } else {
+            t = std::clamp(t, 0.0f, clip.duration);
+        }
+        bool wrapped = t < player.time;
+        player.time = t;
+
+        float* out = values.data() + player.object * stride;
+        uint32_t* cursor = cursors.data() + player.cursorBegin;
+
+        for (uint32_t i = 0; i < clip.trackCount; ++i) {
+            const Track& track = tracks[clip.trackBegin + i];
+            const float* kt = times + track.keyBegin;
+            const float* kv = vals + track.keyBegin;
+            uint32_t last = track.keyCount - 1;
+
+            // 🔹 Ищем отрезок ключей от прошлого места — обычно это 0–1 шаг
+            uint32_t c = wrapped ? 0 : cursor[i];
+            while (c > 0 && kt[c] > t) --c;
+            while (c < last && kt[c + 1] <= t) ++c;
+            cursor[i] = c;
+
+            if (c == last || t <= kt[c]) {
+                out[track.param] = kv[c];
+            } else {
+                // 📈 Линейная интерполяция между соседними ключами
+                float span = kt[c + 1] - kt[c];
+                float f = span > 0.0f ? (t - kt[c]) / span : 1.0f;
+                out[track.param] = kv[c] + (kv[c + 1] - kv[c]) * f;
+            }
+        }
+    }
+}
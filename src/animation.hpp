@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct Animation;
+
+// 🏷️ Имена параметров превращаются в номера один раз при загрузке —
+// в кадре строки не сравниваются и не ищутся
+using ParamId = uint32_t;
+const ParamId INVALID_PARAM = UINT32_MAX;
+
+class ParamTable {
+public:
+    ParamId intern(const std::string& name);     // 🔹 номер имени (новое имя получает следующий)
+    ParamId find(const std::string& name) const; // INVALID_PARAM, если такого имени нет
+    const std::string& name(ParamId id) const { return names[id]; }
+    size_t size() const { return names.size(); }
+
+private:
+    std::unordered_map<std::string, ParamId> ids;
+    std::vector<std::string> names;
+};
+
+// 🎬 Скомпилированные анимации: ключи всех дорожек лежат в двух плотных массивах (время, значение),
+// а update() за один проход считает все проигрывания всех объектов — без строк и без выделений памяти.
+// Результат — таблица значений: строка на объект, столбец на параметр.
+class AnimationSystem {
+public:
+    ParamTable params;
+
+    // 🔨 Собрать клип из ключей: каждый Animation — это ключ в момент time,
+    // его parameters — значения параметров в этот момент (у каждого параметра своя дорожка)
+    uint32_t compileClip(const std::string& name, const std::vector<Animation>& keys, bool loop = true);
+    uint32_t findClip(const std::string& name) const; // UINT32_MAX, если нет
+    size_t clipCount() const { return clips.size(); }
+
+    uint32_t addObject(); // 🔹 новый объект: все его параметры = 0
+    void refreshParams() { restride(); } // 📐 после params.intern() снаружи — расширить таблицу значений
+    size_t objectCount() const { return objects; }
+
+    // ▶️ Проигрывать клип на объекте (несколько клипов на одном объекте пишут поверх друг друга по порядку)
+    void play(uint32_t object, uint32_t clip, float speed = 1.0f, float startTime = 0.0f);
+    void stopAll() { players.clear(); cursors.clear(); }
+    bool playing() const { return !players.empty(); } // 🔹 есть что двигать каждый кадр
+
+    // ⏱️ Продвинуть все проигрывания на deltaTime секунд и записать значения
+    void update(float deltaTime);
+
+    // 🔹 Параметр, интернированный после последнего restride (params.intern без refreshParams), читается как 0
+    float value(uint32_t object, ParamId param) const {
+        return object < objects && param < stride ? values[object * stride + param] : 0.0f;
+    }
+    float* objectValues(uint32_t object) { return values.data() + object * stride; } // stride = params.size()
+    const float* objectValues(uint32_t object) const { return values.data() + object * stride; }
+    void setValue(uint32_t object, ParamId param, float v) {
+        if (object < objects && param < stride) values[object * stride + param] = v;
+    }
+
+private:
+    struct Track { ParamId param; uint32_t keyBegin, keyCount; };
+    struct Clip { std::string name; uint32_t trackBegin, trackCount; float duration; bool loop; };
+    struct Player { uint32_t object, clip, cursorBegin; float time, speed; };
+
+    void restride(); // 📐 новые параметры → шире строка таблицы значений (только при загрузке)
+
+    std::vector<Track> tracks;
+    std::vector<float> keyTimes, keyValues;
+    std::vector<Clip> clips;
+
+    std::vector<Player> players;
+    std::vector<uint32_t> cursors; // последний ключ каждой дорожки каждого проигрывания — поиск идёт от него
+
+    std::vector<float> values;
+    size_t stride = 0;
+    size_t objects = 0;
+};
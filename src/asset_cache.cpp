@@ -0,0 +1,77 @@
+// asset_cache.cpp
+#include "asset_cache.hpp"
+#include "mesh.hpp"
+
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+std::string AssetCache::key(const std::string& path) {
+    std::error_code ec;
+    fs::path normal = fs::weakly_canonical(fs::path(path), ec);
+    return ec ? fs::path(path).lexically_normal().string() : normal.string();
+}
+
+// 🔹 Под блокировкой: живая модель, уже идущая загрузка — или новая запись, и тогда грузить нам (produce)
+AssetCache::MeshFuture AssetCache::lookup(const std::string& k, std::shared_ptr<MeshPromise>& produce) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry& entry = entries[k];
+    if (auto mesh = entry.mesh.lock()) {
+        MeshPromise ready;
+        ready.set_value(std::move(mesh));
+        return ready.get_future().share();
+    }
+    if (entry.pending.valid()) return entry.pending;
+
+    produce = std::make_shared<MeshPromise>();
+    entry.pending = produce->get_future().share();
+    return entry.pending;
+}
+
+void AssetCache::produce(const std::string& k, const std::string& path, MeshPromise& promise) {
+    std::shared_ptr<const Mesh> mesh;
+    try {
+        mesh = std::make_shared<const Mesh>(loader(path)); // 🔹 разбор — без блокировки
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            entries.erase(k);
+        }
+        promise.set_exception(std::current_exception());
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (mesh->pointCount() == 0) {
+            entries.erase(k);
+        } else {
+            Entry& entry = entries[k];
+            entry.mesh = mesh;
+            entry.pending = MeshFuture();
+        }
+    }
+    promise.set_value(std::move(mesh));
+}
+
+std::shared_ptr<const Mesh> AssetCache::load(const std::string& path) {
+    std::string k = key(path);
+    std::shared_ptr<MeshPromise> promise;
+    MeshFuture result = lookup(k, promise);
+    if (promise) produce(k, path, *promise);
+    return result.get();
+}
+
+size_t AssetCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t alive = 0;
+    for (const auto& entry : entries)
+        alive += entry.second.mesh.expired() ? 0 : 1;
+    return alive;
+}
+
+void AssetCache::purge() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = entries.begin(); it != entries.end();)
+        it = it->second.mesh.expired() && !it->second.pending.valid() ? entries.erase(it) : std::next(it);
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+struct Mesh;
+
+// 🗃️ Кэш моделей по пути файла: одна и та же модель грузится один раз и делится между всеми
+// экземплярами сцены. Кэш держит только weak_ptr — модель живёт, пока на неё есть ссылки.
+// Загрузки одного файла из разных потоков склеиваются: второй ждёт результат первого
+class AssetCache {
+public:
+    using Loader = std::function<Mesh(const std::string& path)>;
+    using MeshFuture = std::shared_future<std::shared_ptr<const Mesh>>;
+
+    explicit AssetCache(Loader loader) : loader(std::move(loader)) {}
+
+    // 📦 Живая модель из кэша или новая через loader на вызывающем потоке. Потокобезопасно.
+    // Пустая модель (ошибка загрузки) в кэш не попадает — следующий load() попробует снова
+    std::shared_ptr<const Mesh> load(const std::string& path);
+
+    size_t size() const;  // живых моделей в кэше
+    void purge();         // 🧹 убрать записи моделей, на которые уже никто не ссылается
+
+    static std::string key(const std::string& path); // нормализованный путь — ../a/m.json и a/m.json совпадут
+
+private:
+    using MeshPromise = std::promise<std::shared_ptr<const Mesh>>;
+
+    struct Entry {
+        std::weak_ptr<const Mesh> mesh;
+        MeshFuture pending; // valid(), пока файл грузится
+    };
+
+    MeshFuture lookup(const std::string& key, std::shared_ptr<MeshPromise>& produce);
+    void produce(const std::string& key, const std::string& path, MeshPromise& promise);
+
+    Loader loader;
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+};
@@ -0,0 +1,187 @@
+// bvh.cpp
+#include "bvh.hpp"
+#include "mesh.hpp"
+#include "projection.hpp"
+
+#include <algorithm>
+
+// ───── Построение ─────
+
+static void buildNode(const AABB* boxes, std::vector<BvhNode>& nodes, std::vector<uint32_t>& order,
+                      uint32_t first, uint32_t count) {
+    uint32_t index = uint32_t(nodes.size());
+    nodes.emplace_back();
+
+    BvhNode node;
+    node.first = first;
+    node.count = count;
+
+    AABB centers;
+    for (uint32_t i = first; i < first + count; ++i) {
+        const AABB& box = boxes[order[i]];
+        node.box.expand(box);
+        centers.expand((box.min[0] + box.max[0]) * 0.5f, (box.min[1] + box.max[1]) * 0.5f, (box.min[2] + box.max[2]) * 0.5f);
+    }
+
+    if (count <= BVH_LEAF_SIZE) {
+        nodes[index] = node;
+        return;
+    }
+
+    // 📐 Самая длинная ось разброса центров; делим пополам по медиане
+    int axis = 0;
+    float extent[3];
+    for (int k = 0; k < 3; ++k) extent[k] = centers.max[k] - centers.min[k];
+    if (extent[1] > extent[axis]) axis = 1;
+    if (extent[2] > extent[axis]) axis = 2;
+
+    uint32_t half = count / 2;
+    std::nth_element(order.begin() + first, order.begin() + first + half, order.begin() + first + count,
+                     [&](uint32_t a, uint32_t b) {
+                         return boxes[a].min[axis] + boxes[a].max[axis] < boxes[b].min[axis] + boxes[b].max[axis];
+                     });
+
+    buildNode(boxes, nodes, order, first, half);                 // левый — сразу за родителем
+    node.right = uint32_t(nodes.size());
+    buildNode(boxes, nodes, order, first + half, count - half);
+    nodes[index] = node;
+}
+
+void buildBvh(const AABB* boxes, size_t count, std::vector<BvhNode>& nodes, std::vector<uint32_t>& order) {
+    nodes.clear();
+    order.resize(count);
+    for (size_t i = 0; i < count; ++i) order[i] = uint32_t(i);
+    if (count == 0) return;
+
+    nodes.reserve(2 * (count / BVH_LEAF_SIZE + 1));
+    buildNode(boxes, nodes, order, 0, uint32_t(count));
+}
+
+bool validateBvh(const BvhNode* nodes, size_t nodeCount, size_t itemCount) {
+    if (nodeCount == 0) return true;
+    if (nodeCount > UINT32_MAX) return false;
+
+    // 🔹 Тот же обход, что в cullBvh: внутренний узел на глубине d занимает d + 2 ячейки стека
+    struct Entry { uint32_t index; int depth; };
+    Entry stack[BVH_MAX_DEPTH];
+    int top = 0;
+    stack[top++] = { 0, 0 };
+
+    while (top > 0) {
+        Entry entry = stack[--top];
+        const BvhNode& node = nodes[entry.index];
+        if (uint64_t(node.first) + node.count > itemCount) return false;
+        if (node.leaf()) continue;
+
+        // ⚠️ Левый ребёнок — сразу за родителем, правый — строго после левого: индексы только растут,
+        // поэтому цикл в дереве невозможен
+        uint32_t self = entry.index;
+        if (uint64_t(self) + 1 >= nodeCount || node.right <= self + 1 || node.right >= nodeCount) return false;
+        if (top + 2 > BVH_MAX_DEPTH) return false;
+        stack[top++] = { node.right, entry.depth + 1 };
+        stack[top++] = { self + 1, entry.depth + 1 };
+    }
+    return true;
+}
+
+void buildMeshBounds(Mesh& mesh) {
+    size_t polygons = mesh.polygonCount();
+    std::vector<AABB> boxes(polygons);
+
+    AABB model;
+    for (size_t p = 0; p < polygons; ++p) {
+        AABB& box = boxes[p];
+        for (uint32_t i = mesh.polygonPointBegin(p); i < mesh.polygonPointEnd(p); ++i)
+            box.expand(mesh.x[i], mesh.y[i], mesh.z[i]);
+        model.expand(box);
+    }
+
+    std::vector<BvhNode> nodes;
+    std::vector<uint32_t> order;
+    buildBvh(boxes.data(), boxes.size(), nodes, order);
+
+    mesh.bounds = model;
+    mesh.polygonBounds.assign(boxes.data(), boxes.data() + boxes.size());
+    mesh.bvhNodes.assign(nodes.data(), nodes.data() + nodes.size());
+    mesh.bvhOrder.assign(order.data(), order.data() + order.size());
+}
+
+// ───── Пирамида видимости ─────
+
+Frustum makeFrustum(const ViewProjection& vp) {
+    // 🔹 Плоскости в пространстве вида (x1, y1, z2): экранные границы 0..width и 0..height
+    //    sx = x1 * scale / z + cx >= 0      →  scale * x1 + cx * z >= 0
+    //    sx <= width                        → -scale * x1 + (width - cx) * z >= 0
+    //    sy = -y1 * scale / z + cy >= 0     → -scale * y1 + cy * z >= 0
+    //    sy <= height                       →  scale * y1 + (height - cy) * z >= 0
+    const float viewPlanes[5][4] = {
+        { 0.0f,       0.0f,       1.0f,                    -vp.nearZ },
+        { vp.scale,   0.0f,       vp.centerX,               0.0f },
+        { -vp.scale,  0.0f,       vp.width - vp.centerX,    0.0f },
+        { 0.0f,      -vp.scale,   vp.centerY,               0.0f },
+        { 0.0f,       vp.scale,   vp.height - vp.centerY,   0.0f },
+    };
+
+    // 🌍 В мировые координаты: view = M * world, значит plane_world = plane_view * M
+    const float* m = vp.m;
+    Frustum f;
+    for (int i = 0; i < 5; ++i) {
+        const float* p = viewPlanes[i];
+        f.planes[i][0] = p[0] * m[0] + p[1] * m[4] + p[2] * m[8];
+        f.planes[i][1] = p[0] * m[1] + p[1] * m[5] + p[2] * m[9];
+        f.planes[i][2] = p[0] * m[2] + p[1] * m[6] + p[2] * m[10];
+        f.planes[i][3] = p[0] * m[3] + p[1] * m[7] + p[2] * m[11] + p[3];
+    }
+    return f;
+}
+
+Frustum::Result Frustum::classify(const AABB& box) const {
+    if (box.empty()) return Result::Outside;
+
+    bool inside = true;
+    for (const auto& p : planes) {
+        // 🔹 Самая «положительная» и самая «отрицательная» вершины коробки относительно плоскости
+        float hi = p[3], lo = p[3];
+        for (int k = 0; k < 3; ++k) {
+            float a = p[k] * box.min[k], b = p[k] * box.max[k];
+            hi += std::max(a, b);
+            lo += std::min(a, b);
+        }
+        if (hi < 0) return Result::Outside;
+        if (lo < 0) inside = false;
+    }
+    return inside ? Result::Inside : Result::Intersects;
+}
+
+void cullBvh(const BvhNode* nodes, size_t nodeCount, const uint32_t* order, const AABB* itemBoxes,
+             const Frustum& frustum, std::vector<uint32_t>& visible) {
+    if (nodeCount == 0) return;
+
+    uint32_t stack[BVH_MAX_DEPTH];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        const BvhNode& node = nodes[stack[--top]];
+
+        Frustum::Result result = frustum.classify(node.box);
+        if (result == Frustum::Result::Outside) continue; // ✂️ всё поддерево мимо камеры
+
+        if (result == Frustum::Result::Inside) {
+            // 🔹 Поддерево целиком в кадре — без проверок ниже
+            visible.insert(visible.end(), order + node.first, order + node.first + node.count);
+            continue;
+        }
+
+        if (node.leaf()) {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i)
+                if (!itemBoxes || frustum.intersects(itemBoxes[order[i]]))
+                    visible.push_back(order[i]);
+            continue;
+        }
+
+        uint32_t self = uint32_t(&node - nodes);
+        stack[top++] = node.right;
+        stack[top++] = self + 1;
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <cfloat>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Mesh;
+struct ViewProjection;
+
+// 📦 Ось-выровненный ограничивающий параллелепипед (в см)
+struct AABB {
+    float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+    bool empty() const { return min[0] > max[0]; }
+
+    void expand(float x, float y, float z) {
+        if (x < min[0]) min[0] = x;
+        if (y < min[1]) min[1] = y;
+        if (z < min[2]) min[2] = z;
+        if (x > max[0]) max[0] = x;
+        if (y > max[1]) max[1] = y;
+        if (z > max[2]) max[2] = z;
+    }
+
+    void expand(const AABB& box) {
+        for (int k = 0; k < 3; ++k) {
+            if (box.min[k] < min[k]) min[k] = box.min[k];
+            if (box.max[k] > max[k]) max[k] = box.max[k];
+        }
+    }
+};
+
+// 🌳 Узел BVH. Узлы лежат в порядке обхода в глубину: левый ребёнок — сразу следующий узел.
+// Элементы любого поддерева занимают непрерывный кусок order[first .. first + count) —
+// поэтому целиком видимое поддерево забирается без спуска до листьев.
+struct BvhNode {
+    AABB box;
+    uint32_t first = 0;  // первый элемент поддерева в order
+    uint32_t count = 0;  // элементов в поддереве
+    uint32_t right = 0;  // индекс правого ребёнка; 0 — это лист
+    uint32_t reserved = 0;
+
+    bool leaf() const { return right == 0; }
+};
+
+const uint32_t BVH_LEAF_SIZE = 4;   // элементов в листе
+const int BVH_MAX_DEPTH = 64;       // стек обхода; при делении по медиане глубина ~ log2(n)
+
+// 🔨 Построить BVH над массивом коробок (деление по медиане центров вдоль самой длинной оси)
+void buildBvh(const AABB* boxes, size_t count, std::vector<BvhNode>& nodes, std::vector<uint32_t>& order);
+
+// 🔎 Проверить BVH из чужих рук (файла кэша): дети после родителя, индексы и диапазоны элементов
+// в пределах, глубина помещается в стек обхода cullBvh. Пустое дерево — допустимо
+bool validateBvh(const BvhNode* nodes, size_t nodeCount, size_t itemCount);
+
+// 🔨 Коробки модели и полигонов + BVH по полигонам — считается один раз при загрузке
+void buildMeshBounds(Mesh& mesh);
+
+// 🔺 Пирамида видимости камеры: 5 плоскостей (ближняя + 4 края экрана) в мировых координатах.
+// Точка внутри, если a*x + b*y + c*z + d >= 0 для всех плоскостей.
+struct Frustum {
+    float planes[5][4];
+
+    enum class Result { Outside, Intersects, Inside };
+    Result classify(const AABB& box) const;
+    bool intersects(const AABB& box) const { return classify(box) != Result::Outside; }
+};
+
+Frustum makeFrustum(const ViewProjection& vp);
+
+// ✂️ Индексы видимых элементов BVH (обход с отбрасыванием целых поддеревьев).
+// itemBoxes — коробки самих элементов для точной проверки в листьях (можно nullptr).
+void cullBvh(const BvhNode* nodes, size_t nodeCount, const uint32_t* order, const AABB* itemBoxes,
+             const Frustum& frustum, std::vector<uint32_t>& visible);
@@ -1,30 +1,32 @@
 // core.cpp
 #include "core.hpp"
-#include "json.hpp"
+#include "bvh.hpp"
+#include "damage.hpp"
+#include "mesh.hpp"
+#include "mesh_cache.hpp"
+#include "model_loader.hpp"
+#include "profiler.hpp"
+#include "scene.hpp"
+#include "thread_pool.hpp"
 
 #include <unordered_map> // или <map>
+#include <algorithm>
 #include <chrono>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <vector>
 #include <string>
 #include <cmath>
 #if defined(_WIN32)  // Если Windows
     #include <windows.h>
-
-#else defined(__linux__)  // Если Linux
-    #include <X11/Xlib.h>
-
 #endif
 
-using json = nlohmann::json;
 using namespace std::chrono;
 
 // глобальная переменная:
 steady_clock::time_point lastFrameTime = steady_clock::now();
 
-#define DEG2RAD(angleDegrees) ((angleDegrees) * 3.14159265f / 180.0f)
-
 // ⚠️ Здесь создаются глобальные переменные
 int windowWidth = 640;
 int windowHeight = 480;
@@ -33,40 +35,171 @@ float focalLengthMM = 50.0f; // 👁️ Человеческий глаз
 
 Camera cam; // 🔹 Здесь мы создаём саму переменную
 
+#if defined(_WIN32)
 bool isFullscreen = false;
 WINDOWPLACEMENT windowPosBeforeFullscreen = { sizeof(windowPosBeforeFullscreen) };
 DWORD windowStyleBeforeFullscreen = 0;
+#endif
 
 
-// 🎯 Функция для рисования 3D-точки
-void App::draw3DPoint(HDC hdc, Point3D point) {
-    float dx = point.x - cam.x;
-    float dy = point.y - cam.y;
-    float dz = point.z - cam.z;
+App::App() : assets([this](const std::string& path) { return loader(path); }) {}
 
-    // 📌 Поворот по горизонтали (вокруг вертикальной оси)
-    float x1 = dx * cos(DEG2RAD(-cam.horizontalAngle)) - dz * sin(DEG2RAD(-cam.horizontalAngle));
-    float z1 = dx * sin(-cam.horizontalAngle) + dz * cos(DEG2RAD(-cam.horizontalAngle));
+void App::beginFrame() {
+    beginFrame(cam);
+}
+
+void App::beginFrame(const Camera& camera) {
+    // 📐 Синусы/косинусы углов камеры — один раз на кадр, а не на каждую точку
+    view = makeViewProjection(camera, scale, windowWidth, windowHeight);
+    raster.begin(windowWidth, windowHeight);
+    lighting.beginFrame(camera);
+}
 
-    // 📌 Поворот по вертикали (вокруг горизонтальной оси)
-    float y1 = dy * cos(DEG2RAD(-cam.verticalAngle)) - z1 * sin(DEG2RAD(-cam.verticalAngle));
-    float z2 = dy * sin(DEG2RAD(-cam.verticalAngle)) + z1 * cos(DEG2RAD(-cam.verticalAngle)); // глубина
+// 🎯 Функция для рисования 3D-точки (матрица — из последнего beginFrame())
+void App::draw3DPoint(Framebuffer& fb, Point3D point) {
+    float screenX, screenY, depth;
 
     // ⚠️ Защита от деления на ноль или "отрицательной глубины"
-    if (z2 <= 0.01f) return;
+    if (!view.project(point.x, point.y, point.z, screenX, screenY, depth)) return;
+
+    // ⚠️ Точка может уйти сколь угодно далеко за экран (и в NaN) — приводить к int такое нельзя,
+    // поэтому прижимаем к [-1, размер]: края за буфером setPixel отбросит сам
+    int x = floorToRange(screenX, -1, fb.width);
+    int y = floorToRange(screenY, -1, fb.height);
+
+    // 🖌️ Рисуем пиксель в буфер — на экран он попадёт вместе со всем кадром (полупрозрачный — смешиваем)
+    uint8_t alpha = opacityToAlpha(point.opacity);
+    if (alpha == 255)
+        fb.setPixel(x, y, packRGB(point.r, point.g, point.b));
+    else
+        fb.blendPixel(x, y, packRGB(point.r, point.g, point.b), alpha);
+}
+
+// 🚀 Пакетная версия: модель отсекается по пирамиде видимости (сначала коробка целиком, потом BVH полигонов),
+// проецируются только точки видимых полигонов, а они сами раскладываются по плиткам растеризатора
+void App::drawMesh(const Mesh& mesh, const Transform& transform) {
+    // 🧭 Положение модели вшивается в матрицу — точки и коробки остаются в координатах модели
+    const ViewProjection vp = withTransform(view, transform);
+    size_t count = mesh.pointCount();
+    projected.resize(count);
+    const bool lit = lighting.settings.enabled && mesh.hasMaterials();
+
+    if (!mesh.hasBvh()) {
+        {
+            PROFILE_SCOPE(Stage::Project);
+            projectPoints(vp, mesh.x.data(), mesh.y.data(), mesh.z.data(), count,
+                          projected.x.data(), projected.y.data(), projected.depth.data(), projected.visible.data());
+        }
+        if (lit) {
+            shaded.resize(count);
+            lighting.shade(mesh, transform, nullptr, 0, shaded.data());
+            raster.setShading(shaded.data());
+        }
+        PROFILE_SCOPE(Stage::Raster);
+        raster.submitMesh(vp, mesh, projected);
+        raster.setShading(nullptr);
+        return;
+    }
+
+    {
+        PROFILE_SCOPE(Stage::Cull);
+        Frustum frustum = makeFrustum(vp);
+        if (!frustum.intersects(mesh.bounds)) return; // ✂️ вся модель вне кадра
+
+        visiblePolygons.clear();
+        cullBvh(mesh.bvhNodes.data(), mesh.bvhNodes.size(), mesh.bvhOrder.data(), mesh.polygonBounds.data(),
+                frustum, visiblePolygons);
+        if (visiblePolygons.empty()) return;
 
-    // 📐 Проекция на экран (в логических координатах)
-    float screenX = x1 / z2;
-    float screenY = y1 / z2;
+        // 🔹 По возрастанию — точки соседних полигонов идут подряд и проецируются одним куском
+        std::sort(visiblePolygons.begin(), visiblePolygons.end());
+    }
 
-    // 🎯 Перевод в пиксели
-    int pixelX = static_cast<int>(screenX * app.scale + windowWidth / 2);
-    int pixelY = static_cast<int>(-screenY * app.scale + windowHeight / 2);
+    {
+        PROFILE_SCOPE(Stage::Project);
+        size_t k = 0;
+        while (k < visiblePolygons.size()) {
+            uint32_t begin = mesh.polygonPointBegin(visiblePolygons[k]);
+            uint32_t end = mesh.polygonPointEnd(visiblePolygons[k]);
+            for (++k; k < visiblePolygons.size() && mesh.polygonPointBegin(visiblePolygons[k]) == end; ++k)
+                end = mesh.polygonPointEnd(visiblePolygons[k]);
+
+            projectPoints(vp, mesh.x.data() + begin, mesh.y.data() + begin, mesh.z.data() + begin, end - begin,
+                          projected.x.data() + begin, projected.y.data() + begin,
+                          projected.depth.data() + begin, projected.visible.data() + begin);
+        }
+    }
 
-    // 🖌️ Рисуем пиксель
-    SetPixel(hdc, pixelX, pixelY, RGB(point.r, point.g, point.b));
+    // 💡 Свет — только для точек видимых полигонов
+    if (lit) {
+        shaded.resize(count);
+        lighting.shade(mesh, transform, visiblePolygons.data(), visiblePolygons.size(), shaded.data());
+        raster.setShading(shaded.data());
+    }
+
+    PROFILE_SCOPE(Stage::Raster);
+    raster.submitMesh(vp, mesh, projected, visiblePolygons.data(), visiblePolygons.size());
+    raster.setShading(nullptr);
 }
 
+// 🌍 Сцена: экземпляры отсекаются своим BVH верхнего уровня (по мировым коробкам), видимые
+// сортируются по модели — экземпляры одной модели идут подряд, её массивы остаются в кэше.
+// Положение каждого вшивается в матрицу проекции, так что точки модели не копируются.
+// transforms (если заданы) — по одному на экземпляр, вместо instance.transform.
+// damage (если задан) — экземпляры целиком вне испорченных прямоугольников не рисуются: их пиксели уже в кадре
+void App::drawScene(const Scene& scene, const Transform* transforms, const FrameDamage* damage) {
+    const auto& instances = scene.instances;
+    auto transformOf = [&](size_t i) -> const Transform& { return transforms ? transforms[i] : instances[i].transform; };
+
+    {
+        PROFILE_SCOPE(Stage::Cull);
+        instanceBounds.clear();
+        boxInstance.clear();
+        visibleInstances.clear();
+        for (size_t i = 0; i < instances.size(); ++i) {
+            const Mesh* mesh = instances[i].mesh.get();
+            if (!mesh || mesh->pointCount() == 0) continue;
+            if (damage && !damage->covers(i)) continue;
+            // 🔹 Коробка честная, только если полигоны покрывают все точки (см. Mesh::hasBvh) — иначе рисуем всегда
+            if (!mesh->hasBvh()) {
+                visibleInstances.push_back(uint32_t(i));
+                continue;
+            }
+            instanceBounds.push_back(transformBounds(mesh->bounds, transformOf(i)));
+            boxInstance.push_back(uint32_t(i));
+        }
+
+        // 🌳 BVH по мировым коробкам — экземпляры двигаются, поэтому строится заново каждый кадр
+        buildBvh(instanceBounds.data(), instanceBounds.size(), sceneNodes, sceneOrder);
+        culledBoxes.clear();
+        cullBvh(sceneNodes.data(), sceneNodes.size(), sceneOrder.data(), instanceBounds.data(), makeFrustum(view), culledBoxes);
+        for (uint32_t box : culledBoxes)
+            visibleInstances.push_back(boxInstance[box]);
+
+        std::sort(visibleInstances.begin(), visibleInstances.end(), [&](uint32_t a, uint32_t b) {
+            const Mesh* ma = instances[a].mesh.get();
+            const Mesh* mb = instances[b].mesh.get();
+            return ma != mb ? ma < mb : a < b;
+        });
+    }
+
+    // 💡 Источники и карта теней — по всей сцене, не только по видимому: тень может падать из-за кадра
+    if (lighting.settings.enabled)
+        lighting.prepareScene(scene, transforms, threadPool());
+
+    for (uint32_t i : visibleInstances) {
+        raster.setTint(instances[i].tint);
+        drawMesh(*instances[i].mesh, transformOf(i));
+    }
+    raster.setTint(TINT_NONE);
+}
+
+void App::endFrame(Framebuffer& fb, const FrameDamage* damage) {
+    PROFILE_SCOPE(Stage::Raster);
+    raster.flush(fb, threadPool(), damage && !damage->full ? &damage->rects : nullptr);
+}
+
+#if defined(_WIN32)
 
 LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
     switch (msg) {
@@ -112,6 +245,17 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             windowHeight = HIWORD(lParam);
             break;
 
+        case WM_PAINT: {
+            // 🖼️ Перерисовка окна — просто копируем готовый кадр
+            PAINTSTRUCT ps;
+            HDC hdc = BeginPaint(hwnd, &ps);
+            ScreenRect area = { int(ps.rcPaint.left), int(ps.rcPaint.top), int(ps.rcPaint.right), int(ps.rcPaint.bottom) };
+            presentFramebuffer(hdc, app.frame, &area); // 🩹 только то, что помечено InvalidateRect
+            EndPaint(hwnd, &ps);
+            profiler().nextFrame(); // ⏱️ кадр потока рендера кончается выводом на экран
+            return 0;
+        }
+
         case WM_DPICHANGED: {
             // lParam — это указатель на RECT с новой рекомендованной областью окна
             RECT* suggestedRect = (RECT*)lParam;
@@ -140,6 +284,7 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 
     return DefWindowProc(hwnd, msg, wParam, lParam); // Остальные сообщения — Windows сама
 }
+#endif
 
 void App::setDPI(int dpiValue) {
     dpi = dpiValue;
@@ -148,83 +293,137 @@ void App::setDPI(int dpiValue) {
 
 // ───── Загрузчик модели ─────
 
-Model App::loader(const std::string& path) {
-    std::ifstream file(path);
-    if (!file) {
-        std::cerr << "Failed to open file: " << path << '\n';
-        return Model{}; // ← Вернёт "пустую" модель
+// 🧩 Разбор JSON в Mesh (потоковый, без дерева документа) с понятной ошибкой
+static bool parseModelFile(const std::string& path, Mesh& mesh) {
+    ModelParseError error;
+    if (!parseModelJson(path, mesh, error)) {
+        std::cerr << "Failed to load model " << path << " at byte " << error.byteOffset << ": " << error.message << '\n';
+        return false;
     }
+    buildMeshBounds(mesh); // 🌳 коробки и BVH — один раз, дальше они едут в кэше
+    return true;
+}
 
-    json j;
-    file >> j;
-
-    Model model;
-    model.modelName = j["modelName"];
-    model.castShadow = j["castShadow"];
-
-    for (const auto& jPoly : j["polygons"]) {
-        Polygon3D poly;
-        poly.roughness = jPoly["roughness"];
-        poly.metallic = jPoly["metallic"];
-        poly.lightTarget = jPoly["lightTarget"];
-        poly.lightType = jPoly["lightType"];
-
-        for (const auto& jLine : jPoly["lines"]) {
-            Line line;
-
-            for (const auto& jPoint : jLine["points"]) {
-                Point3D p;
-                p.x = jPoint["x"];
-                p.y = jPoint["y"];
-                p.z = jPoint["z"];
-                p.r = jPoint["r"];
-                p.g = jPoint["g"];
-                p.b = jPoint["b"];
-                p.opacity = jPoint["opacity"];
-                p.lightIntensity = jPoint["lightIntensity"];
-                line.points.push_back(p);
-            }
+Mesh App::loader(const std::string& path) {
+    Mesh mesh;
+    bool fromCache = false;
 
-            poly.lines.push_back(line);
+    if (isMeshCachePath(path)) {
+        // 💾 Явно передан кэш — отображаем без проверки исходника
+        if (!readMeshCache(path, mesh)) {
+            std::cerr << "Failed to read mesh cache: " << path << '\n';
+            return Mesh{}; // ← Вернёт "пустую" модель
         }
-
-        model.polygons.push_back(poly);
+        fromCache = true;
+    } else if (useMeshCache && readMeshCache(meshCachePath(path), mesh, path)) {
+        fromCache = true; // 🗺️ Свежий кэш рядом с JSON — разбор не нужен
+    } else {
+        if (!parseModelFile(path, mesh))
+            return Mesh{}; // ← Вернёт "пустую" модель
+        buildMeshNormals(mesh); // 📐 до записи — нормали идут в кэш
+        if (useMeshCache && !writeMeshCache(meshCachePath(path), mesh, path))
+            std::cerr << "Failed to write mesh cache: " << meshCachePath(path) << '\n';
     }
 
+    buildMeshMaterials(mesh); // 💡 строки материалов → номера (нормали — из кэша или посчитанные выше)
+
     // ───── Отладочный вывод ─────
-    std::cout << "Model loaded: " << model.modelName << "\n";
-    std::cout << "Shadows: " << (model.castShadow ? "enabled" : "disabled") << "\n";
-    std::cout << "Polygon count: " << model.polygons.size() << "\n";
-
-    for (size_t i = 0; i < model.polygons.size(); ++i) {
-        const auto& p = model.polygons[i];
-        std::cout << "  Polygon " << i << ": lines = " << p.lines.size()
-                << ", roughness = " << p.roughness
-                << ", metallic = " << p.metallic
-                << ", lightType = " << p.lightType << "\n";
+    // 🔹 Одним куском: модели сцены грузятся параллельно, строки разных файлов не должны перемешиваться
+    const Mesh& loaded = mesh; // 🔹 только чтение: массивы кэша остаются отображёнными
+    std::ostringstream log;
+    log << "Model loaded: " << mesh.modelName << (fromCache ? " (cache)" : "") << "\n";
+    log << "Shadows: " << (mesh.castShadow ? "enabled" : "disabled") << "\n";
+    log << "Polygon count: " << mesh.polygonCount() << ", points: " << mesh.pointCount() << "\n";
+
+    for (size_t i = 0; i < loaded.polygonCount() && i < 16; ++i) {
+        log << "  Polygon " << i << ": lines = " << (loaded.polygonLineEnd(i) - loaded.polygonLineBegin(i))
+            << ", roughness = " << loaded.roughness[i]
+            << ", metallic = " << loaded.metallic[i]
+            << ", lightType = " << loaded.lightType[i] << "\n";
     }
-    return model;
+    std::cout << log.str();
+    return mesh;
 }
 
-void App::clear(HDC hdc) {
-    //HDC hdc = GetDC(hwnd);
-    RECT rect = { 0, 0, windowWidth, windowHeight };
+bool App::bake(const std::string& path) {
+    // 🔁 Всегда разбираем JSON заново — даже если кэш выглядит свежим
+    Mesh mesh;
+    if (!parseModelFile(path, mesh)) return false;
+    buildMeshNormals(mesh);
 
-    HBRUSH blackBrush = CreateSolidBrush(RGB(0, 0, 0));
-    FillRect(hdc, &rect, blackBrush);
-    DeleteObject(blackBrush);
+    std::string cachePath = meshCachePath(path);
+    if (!writeMeshCache(cachePath, mesh, path)) {
+        std::cerr << "Failed to write mesh cache: " << cachePath << '\n';
+        return false;
+    }
+    std::cout << "Baked: " << cachePath << " (" << mesh.pointCount() << " points)\n";
+    return true;
+}
 
-    //ReleaseDC(hwnd, hdc);
+void App::clear(Framebuffer& fb, const FrameDamage* damage) {
+    // 🔹 Подгоняем буфер под окно и заливаем чёрным — без кистей и системных вызовов
+    bool resized = fb.width != windowWidth || fb.height != windowHeight;
+    if (resized)
+        fb.resize(windowWidth, windowHeight);
+
+    // 🩹 Только испорченное — остальной кадр (цвет и глубина) остаётся с прошлого раза
+    if (damage && !damage->full && !resized) {
+        for (const ScreenRect& rect : damage->rects)
+            fb.clear(rect, packRGB(0, 0, 0));
+        return;
+    }
+    fb.clear(packRGB(0, 0, 0));
 }
 
-void App::animate(Animation animation) {
+// ───── Сценарии и анимация ─────
+
+bool App::loadScript(const std::string& path) {
+    if (!cameraBound) {
+        scriptBindings.bind("cam.x", &cam.x);
+        scriptBindings.bind("cam.y", &cam.y);
+        scriptBindings.bind("cam.z", &cam.z);
+        scriptBindings.bind("cam.horizontalAngle", &cam.horizontalAngle);
+        scriptBindings.bind("cam.verticalAngle", &cam.verticalAngle);
+        cameraBound = true;
+    }
+
+    Script script;
+    ScriptError error;
+    if (!loadScriptFile(path, scriptBindings, script, error)) {
+        std::cerr << "Failed to load script " << path << " at line " << error.line << ": " << error.message << '\n';
+        return false;
+    }
+    std::cout << "Script loaded: " << path << " (" << script.codeSize() << " instructions)\n";
+    scripts.push_back(std::move(script));
+    return true;
+}
+
+void App::animate() {
     // вычисляем прошедшее время
     steady_clock::time_point now = steady_clock::now();
     float deltaTime = duration<float>(now - lastFrameTime).count();
     lastFrameTime = now;
 
-    // 🎯 Пример: движение объекта
-    //object.x += objectSpeed * deltaTime;
+    animate(deltaTime);
+}
 
-    // остальной код...
-}
\ No newline at end of file
+void App::resetClock() {
+    lastFrameTime = steady_clock::now();
+}
+
+void App::animate(float deltaTime) {
+    scriptTime += deltaTime;
+
+    // 📜 Сначала сценарии (могут менять камеру, модели и параметры анимаций)
+    {
+        PROFILE_SCOPE(Stage::Script);
+        for (Script& script : scripts) {
+            if (!script.run(deltaTime, scriptTime) && script.overBudgetCount == 1)
+                std::cerr << "Script " << script.name << " exceeded its budget of " << script.budget << " instructions\n";
+        }
+    }
+
+    // 🎯 Все объекты за один проход: ключи уже разложены по дорожкам, имена — номера
+    PROFILE_SCOPE(Stage::Animate);
+    animations.update(deltaTime);
+}
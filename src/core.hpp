@@ -2,6 +2,16 @@
 #include <string>
 #include <vector>
 #include <unordered_map> // или <map>
+#include <cstdint>
+
+#include "animation.hpp"
+#include "asset_cache.hpp"
+#include "bvh.hpp"
+#include "framebuffer.hpp"
+#include "lighting.hpp"
+#include "projection.hpp"
+#include "raster.hpp"
+#include "script.hpp"
 
 #if defined(_WIN32)
     #include <windows.h>
@@ -9,10 +19,6 @@
     LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
 #endif
 
-#ifdef __linux__
-    #include <X11/Xlib.h>
-#endif
-
 
 // 📌 Глобальные переменные — доступны во всех файлах, но создаются один раз
 extern int windowWidth;
@@ -20,8 +26,11 @@ extern int windowHeight;
 
 extern float focalLengthMM;
 
+// 🎬 Ключ анимации: значения параметров в момент time. Это формат загрузки —
+// в кадре работают скомпилированные дорожки (AnimationSystem::compileClip, см. animation.hpp)
 struct Animation {
     std::string name; // имя анимации
+    float time = 0.0f; // 🕒 время ключа в секундах от начала клипа
 
     // список параметров: вектор из пар ключ-значение
     std::vector<std::pair<std::string, float>> parameters;
@@ -52,28 +61,70 @@ struct Model {
     std::vector<Polygon3D> polygons;
 };
 
+// 🧭 Положение модели в мире: сдвиг (в см), поворот вокруг вертикали (в градусах), масштаб
+struct Transform {
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+    float rotationY = 0.0f;
+    float scale = 1.0f;
+
+    bool isIdentity() const { return x == 0.0f && y == 0.0f && z == 0.0f && rotationY == 0.0f && scale == 1.0f; }
+};
+
 struct Camera {
     float x = 50.0f;  // Положение камеры по X
     float y = 50.0f;  // Положение камеры по Y
     float z = -200.0f;  // Положение камеры по Z (например, стоит позади центра сцены)
 
-    float horizontalAngle = 0.0f; // Поворот влево-вправо (в радианах)
-    float verticalAngle = 0.0f;   // Поворот вверх-вниз (в радианах)
+    float horizontalAngle = 0.0f; // Поворот влево-вправо (в градусах)
+    float verticalAngle = 0.0f;   // Поворот вверх-вниз (в градусах)
 };
 extern Camera cam;  // 🔹 Объявляем, что переменная будет где-то создана
 
+struct Mesh; // 📦 Плоская модель — см. mesh.hpp
+class Scene; // 🌍 Экземпляры общих моделей — см. scene.hpp
+struct FrameDamage; // 🩹 Что перерисовать в кадре — см. damage.hpp
+
 class App {
 public:
     int dpi = 96;
     float scale = 1.0f;
+    bool useMeshCache = true; // 💾 loader() читает/пишет бинарный кэш рядом с JSON
+
+    Framebuffer frame; // 🖼️ Сюда рисуется весь кадр, на экран — одним блитом
+    ViewProjection view; // 📐 Матрица текущего кадра — обновляется в beginFrame()
+    Rasterizer raster;   // 🧱 Линии, полигоны и точки с z-буфером; настройки — raster.settings
+    AnimationSystem animations; // 🎬 Все клипы и проигрывания — считаются пачкой в animate()
+    ScriptBindings scriptBindings; // 🔗 Что видят сценарии: cam.* всегда, остальное — bind...() до loadScript()
+    std::vector<Script> scripts;   // 📜 Выполняются по порядку в начале animate()
+    AssetCache assets; // 🗃️ Общие модели для Scene — грузятся через loader() один раз на файл
+    Lighting lighting; // 💡 Свет и тени — lighting.settings.enabled, иначе цвета точек как есть
+
+    App();
 
     void setDPI(int dpiValue); // функция для установки dpi
-    Model loader(const std::string& path);   // 📦 Загрузка модели
-    void draw3DPoint(HDC hdc, Point3D point);       // 🔹 Рисуем что-то
-    void clear(HDC hdc);       // стереть всё
-    void animate(Animation animation);
+    Mesh loader(const std::string& path);    // 📦 Загрузка модели сразу в плоский Mesh (старый Model — через toModel)
+    bool bake(const std::string& path);      // 💾 Заранее собрать бинарный кэш для JSON-модели
+    void beginFrame();                                // 📐 Пересчитать view из cam/scale/размера окна — раз за кадр
+    void beginFrame(const Camera& camera);            // 📐 То же для камеры из снимка (поток рендера не трогает cam)
+    void draw3DPoint(Framebuffer& fb, Point3D point); // 🔹 Рисуем одну точку в кадровый буфер (сразу, без z-буфера)
+    void drawMesh(const Mesh& mesh, const Transform& transform = Transform()); // 🚀 Проецируем модель пачкой и отдаём растеризатору
+    // 🌍 Все экземпляры (transforms — из снимка; damage — только задевающие испорченные прямоугольники)
+    void drawScene(const Scene& scene, const Transform* transforms = nullptr, const FrameDamage* damage = nullptr);
+    void endFrame(Framebuffer& fb, const FrameDamage* damage = nullptr); // 🧱 Растеризуем всё за кадр по плиткам на всех ядрах
+    void clear(Framebuffer& fb, const FrameDamage* damage = nullptr);    // стереть всё (или только испорченное)
+    bool loadScript(const std::string& path);    // 📜 Скомпилировать сценарий и добавить в scripts
+    void animate();                    // 🎬 Сценарии + анимации за время с прошлого кадра
+    void animate(float deltaTime);     // 🎬 То же с заданным шагом (headless, повторяемые кадры)
+    void resetClock();                 // ⏱️ Отсчёт animate() — от этого момента (загрузка не попадёт в первый шаг)
 
 private:
-
+    ProjectedPoints projected; // 🧺 Буферы пакетной проекции, живут между кадрами
+    std::vector<uint32_t> visiblePolygons; // 🧺 Результат отсечения по BVH, тоже переиспользуется
+    std::vector<uint32_t> shaded;          // 🧺 Освещённые цвета точек модели (Lighting::shade)
+    std::vector<AABB> instanceBounds;      // 🧺 Верхний уровень для drawScene: мировые коробки экземпляров,
+    std::vector<BvhNode> sceneNodes;       //    BVH над ними и видимые экземпляры — строятся каждый кадр
+    std::vector<uint32_t> sceneOrder, boxInstance, culledBoxes, visibleInstances;
+    float scriptTime = 0.0f;               // ⏱️ time в сценариях — секунды с первого animate()
+    bool cameraBound = false;
 };
 extern App app;
\ No newline at end of file
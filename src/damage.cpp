@@ -0,0 +1,134 @@
+// damage.cpp
+#include "damage.hpp"
+#include "mesh.hpp"
+#include "scene.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// 🔹 Вся проекция кадра, а не только камера: App::scale и focalLengthMM тоже сдвигают каждый пиксель
+static bool sameView(const ViewProjection& a, const ViewProjection& b) {
+    return std::equal(std::begin(a.m), std::end(a.m), std::begin(b.m)) && a.scale == b.scale &&
+           a.centerX == b.centerX && a.centerY == b.centerY && a.width == b.width && a.height == b.height &&
+           a.nearZ == b.nearZ;
+}
+
+static bool sameTransform(const Transform& a, const Transform& b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z && a.rotationY == b.rotationY && a.scale == b.scale;
+}
+
+// 📦 Экранная коробка экземпляра: углы мировой коробки модели через матрицу кадра.
+// Коробки нет или она заходит за ближнюю плоскость — считаем, что экземпляр может быть где угодно
+ScreenRect DamageTracker::screenRect(const Mesh* mesh, const Transform& transform, const ViewProjection& view) const {
+    const ScreenRect whole = { 0, 0, width, height };
+    if (!mesh || mesh->pointCount() == 0) return ScreenRect();
+    if (!mesh->hasBvh() || mesh->bounds.empty()) return whole; // 🔹 коробка честная только с BVH (см. drawScene)
+
+    AABB box = transformBounds(mesh->bounds, transform);
+    float minX = INFINITY, minY = INFINITY, maxX = -INFINITY, maxY = -INFINITY;
+    for (int corner = 0; corner < 8; ++corner) {
+        float sx, sy, depth;
+        if (!view.project((corner & 1) ? box.max[0] : box.min[0], (corner & 2) ? box.max[1] : box.min[1],
+                          (corner & 4) ? box.max[2] : box.min[2], sx, sy, depth))
+            return whole;
+        minX = std::min(minX, sx); maxX = std::max(maxX, sx);
+        minY = std::min(minY, sy); maxY = std::max(maxY, sy);
+    }
+
+    // ✂️ Обрезаем по кадру заранее — огромные числа дальних коробок не переполняют int
+    minX = std::max(minX, 0.0f); minY = std::max(minY, 0.0f);
+    maxX = std::min(maxX, float(width)); maxY = std::min(maxY, float(height));
+    if (minX > maxX || minY > maxY) return ScreenRect(); // целиком вне кадра
+
+    ScreenRect rect = { int(std::floor(minX)) - PADDING, int(std::floor(minY)) - PADDING,
+                        int(std::ceil(maxX)) + 1 + PADDING, int(std::ceil(maxY)) + 1 + PADDING };
+    rect.x0 = std::max(rect.x0, 0); rect.y0 = std::max(rect.y0, 0);
+    rect.x1 = std::min(rect.x1, width); rect.y1 = std::min(rect.y1, height);
+    return rect;
+}
+
+bool DamageTracker::update(const ViewProjection& frameView, int frameWidth, int frameHeight,
+                           int tileSize, const Scene& scene, const Transform* transforms, bool sceneWide,
+                           FrameDamage& out) {
+    const auto& sceneInstances = scene.instances;
+    auto transformOf = [&](size_t i) -> const Transform& { return transforms ? transforms[i] : sceneInstances[i].transform; };
+
+    // 🎥 Матрица кадра или размер поменялись — сдвинулось всё
+    bool full = !valid || !sameView(view, frameView) || width != frameWidth || height != frameHeight ||
+                instances.size() != sceneInstances.size();
+    view = frameView;
+    width = frameWidth;
+    height = frameHeight;
+    valid = true;
+
+    instances.resize(sceneInstances.size());
+    dirty.clear();
+    for (size_t i = 0; i < sceneInstances.size(); ++i) {
+        InstanceState& state = instances[i];
+        const Instance& instance = sceneInstances[i];
+        const Transform& transform = transformOf(i);
+        bool changed = full || state.mesh != instance.mesh.get() || state.tint != instance.tint ||
+                       !sameTransform(state.transform, transform);
+        if (!changed) continue;
+
+        // 🩹 Старое место стирается, новое рисуется
+        ScreenRect rect = screenRect(instance.mesh.get(), transform, view);
+        if (!full) {
+            if (!state.rect.empty()) dirty.push_back(state.rect);
+            if (!rect.empty()) dirty.push_back(rect);
+        }
+        state = { instance.mesh.get(), transform, instance.tint, rect };
+    }
+
+    out.instances.assign(sceneInstances.size(), 1);
+    out.rects.clear();
+    out.full = full || (sceneWide && !dirty.empty());
+    if (out.full) return true;
+    if (dirty.empty()) return false; // 💤 ничего не изменилось
+
+    finish(tileSize, out);
+    return true;
+}
+
+// 🧱 Прямоугольники → по границам плиток, пересекающиеся сливаются; много или большая площадь — весь кадр
+void DamageTracker::finish(int tileSize, FrameDamage& out) {
+    int ts = std::max(8, tileSize);
+    for (ScreenRect& rect : dirty) {
+        rect.x0 = rect.x0 / ts * ts;
+        rect.y0 = rect.y0 / ts * ts;
+        rect.x1 = std::min(width, (rect.x1 + ts - 1) / ts * ts);
+        rect.y1 = std::min(height, (rect.y1 + ts - 1) / ts * ts);
+    }
+
+    for (bool merged = true; merged;) {
+        merged = false;
+        for (size_t i = 0; i < dirty.size() && !merged; ++i) {
+            for (size_t j = i + 1; j < dirty.size(); ++j) {
+                if (!dirty[i].intersects(dirty[j])) continue;
+                dirty[i].merge(dirty[j]);
+                dirty[j] = dirty.back();
+                dirty.pop_back();
+                merged = true;
+                break;
+            }
+        }
+    }
+    if (dirty.size() > MAX_RECTS) {
+        ScreenRect all;
+        for (const ScreenRect& rect : dirty) all.merge(rect);
+        dirty.assign(1, all);
+    }
+
+    int64_t area = 0;
+    for (const ScreenRect& rect : dirty) area += rect.area();
+    if (double(area) > double(FULL_AREA) * double(width) * double(height)) {
+        out.full = true;
+        return;
+    }
+
+    out.rects = dirty;
+    for (size_t i = 0; i < instances.size(); ++i) {
+        const ScreenRect& rect = instances[i].rect;
+        out.instances[i] = std::any_of(dirty.begin(), dirty.end(), [&](const ScreenRect& d) { return d.intersects(rect); });
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core.hpp"
+#include "framebuffer.hpp"
+#include "projection.hpp"
+
+struct Mesh;  // 📦 см. mesh.hpp
+class Scene;  // 🌍 см. scene.hpp
+
+// 🩹 Что перерисовать в кадре: весь или только прямоугольники (по границам плиток растеризатора —
+// тогда плитка либо рисуется целиком, либо не трогается, и кадр совпадает с полной перерисовкой)
+struct FrameDamage {
+    bool full = true;
+    std::vector<ScreenRect> rects;  // при full — не используются
+    std::vector<uint8_t> instances; // по экземпляру сцены: 1 — задевает rects (при full — все 1)
+
+    bool none() const { return !full && rects.empty(); }
+    bool covers(size_t instance) const { return full || (instance < instances.size() && instances[instance]); }
+};
+
+// 🔎 Изменения между кадрами: матрица кадра (камера, масштаб, фокусное расстояние), размер окна,
+// положение/модель/оттенок экземпляров.
+// Помнит последний нарисованный кадр и экранную коробку каждого экземпляра в нём —
+// сдвинутый экземпляр портит свою старую и новую коробки, а всё остальное остаётся на экране как есть
+class DamageTracker {
+public:
+    static constexpr size_t MAX_RECTS = 16;   // 🔹 больше — сливаем в один общий прямоугольник
+    static constexpr float FULL_AREA = 0.5f;  // 🔹 испорчено больше половины кадра — проще целиком
+    static constexpr int PADDING = 2;         // пикселей вокруг коробки: линии и точки на её границе
+
+    // 📐 Сравнить кадр с последним нарисованным (view — App::view после beginFrame) и запомнить его.
+    // false — ничего не изменилось, рисовать не нужно. sceneWide — освещение: любое изменение
+    // (тени, точечные источники) может задеть весь кадр
+    bool update(const ViewProjection& view, int width, int height, int tileSize,
+                const Scene& scene, const Transform* transforms, bool sceneWide, FrameDamage& out);
+
+    void invalidate() { valid = false; } // 🔁 следующий кадр — целиком
+
+private:
+    struct InstanceState {
+        const Mesh* mesh = nullptr;
+        Transform transform;
+        uint32_t tint = 0;
+        ScreenRect rect; // где был на экране
+    };
+
+    ScreenRect screenRect(const Mesh* mesh, const Transform& transform, const ViewProjection& view) const;
+    void finish(int tileSize, FrameDamage& out);
+
+    bool valid = false;
+    ViewProjection view; // 📐 матрица последнего нарисованного кадра
+    int width = 0, height = 0;
+    std::vector<InstanceState> instances;
+    std::vector<ScreenRect> dirty;
+};
@@ -0,0 +1,43 @@
+// frame_pipeline.cpp
+#include "frame_pipeline.hpp"
+
+void SimulationLoop::start(const FrameSnapshot& initial, Step stepFn, std::function<void()> publishFn, double hz) {
+    stop();
+    snapshots.reset(initial);
+    step = std::move(stepFn);
+    onPublish = std::move(publishFn);
+    period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / hz));
+    stopping = false;
+    thread = std::thread(&SimulationLoop::run, this);
+}
+
+void SimulationLoop::stop() {
+    if (!thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    thread.join();
+}
+
+void SimulationLoop::run() {
+    uint64_t frame = 0;
+    auto next = std::chrono::steady_clock::now();
+
+    while (true) {
+        FrameSnapshot& out = snapshots.writeSlot();
+        step(out);
+        out.frame = ++frame;
+        snapshots.publish();
+        if (onPublish) onPublish();
+
+        // ⏳ Ровный шаг; если отстали больше чем на шаг — не догоняем пачкой, а начинаем отсчёт заново
+        next += period;
+        auto now = std::chrono::steady_clock::now();
+        if (now > next + period) next = now;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if (wake.wait_until(lock, next, [&] { return stopping; })) return;
+    }
+}
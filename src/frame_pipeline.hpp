@@ -0,0 +1,90 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "core.hpp"
+
+// 📸 Неизменяемый снимок состояния для одного кадра: всё, что нужно рендеру от симуляции
+struct FrameSnapshot {
+    uint64_t frame = 0;
+    Camera camera;
+    std::vector<Transform> transforms; // по объекту сцены; ёмкость переиспользуется между кадрами
+};
+
+// 🔄 Тройной буфер без блокировок: один писатель, один читатель.
+// Писатель всегда пишет в свой слот, читатель всегда читает свой, а третий — «посередине»:
+// publish() и acquire() лишь меняют свой слот со средним одним атомарным exchange.
+template <typename T>
+class TripleBuffer {
+public:
+    // 🔹 Все три слота — одинаковое начальное состояние (до первого publish читатель видит его)
+    void reset(const T& value) {
+        for (T& slot : slots) slot = value;
+        writeIndex = 0;
+        middle.store(1, std::memory_order_relaxed);
+        readIndex = 2;
+    }
+
+    T& writeSlot() { return slots[writeIndex]; }
+
+    // ✍️ Отдать записанный слот читателю (старый непрочитанный снимок просто перезаписывается)
+    void publish() {
+        uint8_t previous = middle.exchange(uint8_t(writeIndex | FRESH), std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+    // 📖 Забрать самый свежий снимок. false — нового нет, readSlot() прежний
+    bool acquire() {
+        if (!(middle.load(std::memory_order_acquire) & FRESH)) return false;
+        uint8_t previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    const T& readSlot() const { return slots[readIndex]; }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH = 0x4; // в среднем слоте лежит ещё не прочитанный снимок
+
+    T slots[3];
+    uint8_t writeIndex = 0;           // только писатель
+    std::atomic<uint8_t> middle{ 1 }; // общий: индекс среднего слота + флаг FRESH
+    uint8_t readIndex = 2;            // только читатель
+};
+
+// 🧵 Поток симуляции: с постоянным шагом вызывает step (сценарии, анимации → снимок),
+// публикует снимок и будит рендер через onPublish. Рендер тем временем рисует предыдущий кадр.
+class SimulationLoop {
+public:
+    using Step = std::function<void(FrameSnapshot& out)>;
+
+    ~SimulationLoop() { stop(); }
+
+    void start(const FrameSnapshot& initial, Step step, std::function<void()> onPublish, double hz = 60.0);
+    void stop();
+    bool running() const { return thread.joinable(); }
+
+    // 🖼️ Сторона рендера (один поток)
+    bool acquire() { return snapshots.acquire(); }
+    const FrameSnapshot& latest() const { return snapshots.readSlot(); }
+
+private:
+    void run();
+
+    TripleBuffer<FrameSnapshot> snapshots;
+    Step step;
+    std::function<void()> onPublish;
+    std::chrono::steady_clock::duration period{};
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
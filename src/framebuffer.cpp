@@ -0,0 +1,210 @@
+// framebuffer.cpp
+#include "framebuffer.hpp"
+#include "framebuffer_x11.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+
+#ifdef ENGINE_HAS_X11
+    #include <X11/Xutil.h> // XDestroyImage
+#endif
+
+void Framebuffer::resize(int w, int h) {
+    width = std::max(w, 0);
+    height = std::max(h, 0);
+    color.resize(size_t(width) * height);
+    depth.resize(size_t(width) * height);
+}
+
+void Framebuffer::clear(uint32_t rgb, float depthValue) {
+    std::fill(color.begin(), color.end(), rgb);
+    std::fill(depth.begin(), depth.end(), depthValue);
+}
+
+void Framebuffer::clear(const ScreenRect& rect, uint32_t rgb, float depthValue) {
+    int x0 = std::max(rect.x0, 0), x1 = std::min(rect.x1, width);
+    int y0 = std::max(rect.y0, 0), y1 = std::min(rect.y1, height);
+    if (x0 >= x1) return;
+    for (int y = y0; y < y1; ++y) {
+        size_t row = size_t(y) * width;
+        std::fill(color.begin() + row + x0, color.begin() + row + x1, rgb);
+        std::fill(depth.begin() + row + x0, depth.begin() + row + x1, depthValue);
+    }
+}
+
+bool Framebuffer::savePPM(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    file << "P6\n" << width << " " << height << "\n255\n";
+
+    // 🔹 Одна строка за раз — без лишней копии всего кадра
+    std::vector<uint8_t> row(size_t(width) * 3);
+    for (int y = 0; y < height; ++y) {
+        const uint32_t* src = &color[size_t(y) * width];
+        for (int x = 0; x < width; ++x) {
+            row[x * 3 + 0] = uint8_t(src[x] >> 16);
+            row[x * 3 + 1] = uint8_t(src[x] >> 8);
+            row[x * 3 + 2] = uint8_t(src[x]);
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+    return bool(file);
+}
+
+// ───── PNG: CRC32 и Adler32 — минимум, чтобы обойтись без zlib ─────
+
+static uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t size) {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+        return t;
+    }();
+    for (size_t i = 0; i < size; ++i)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+static void writeBE32(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(uint8_t(v >> 24));
+    out.push_back(uint8_t(v >> 16));
+    out.push_back(uint8_t(v >> 8));
+    out.push_back(uint8_t(v));
+}
+
+static void writeChunk(std::ofstream& file, const char type[4], const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> head;
+    writeBE32(head, uint32_t(data.size()));
+    head.insert(head.end(), type, type + 4);
+
+    uint32_t crc = crc32Update(0xFFFFFFFFu, head.data() + 4, 4);
+    crc = crc32Update(crc, data.data(), data.size()) ^ 0xFFFFFFFFu;
+
+    std::vector<uint8_t> tail;
+    writeBE32(tail, crc);
+
+    file.write(reinterpret_cast<const char*>(head.data()), head.size());
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    file.write(reinterpret_cast<const char*>(tail.data()), tail.size());
+}
+
+bool Framebuffer::savePNG(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+    std::vector<uint8_t> ihdr;
+    writeBE32(ihdr, uint32_t(width));
+    writeBE32(ihdr, uint32_t(height));
+    ihdr.insert(ihdr.end(), { 8, 2, 0, 0, 0 }); // 8 бит, RGB, deflate, фильтр, без interlace
+    writeChunk(file, "IHDR", ihdr);
+
+    // 🔹 Сырые строки: байт фильтра (0) + RGB
+    std::vector<uint8_t> raw;
+    raw.reserve(size_t(height) * (size_t(width) * 3 + 1));
+    for (int y = 0; y < height; ++y) {
+        raw.push_back(0);
+        const uint32_t* src = &color[size_t(y) * width];
+        for (int x = 0; x < width; ++x) {
+            raw.push_back(uint8_t(src[x] >> 16));
+            raw.push_back(uint8_t(src[x] >> 8));
+            raw.push_back(uint8_t(src[x]));
+        }
+    }
+
+    // 📦 zlib-поток из stored-блоков (по 65535 байт)
+    std::vector<uint8_t> idat = { 0x78, 0x01 };
+    uint32_t a = 1, b = 0;
+    for (uint8_t v : raw) {
+        a = (a + v) % 65521;
+        b = (b + a) % 65521;
+    }
+    size_t pos = 0;
+    do {
+        size_t len = std::min<size_t>(raw.size() - pos, 65535);
+        bool last = pos + len == raw.size();
+        idat.push_back(last ? 1 : 0);
+        idat.push_back(uint8_t(len));
+        idat.push_back(uint8_t(len >> 8));
+        idat.push_back(uint8_t(~len));
+        idat.push_back(uint8_t(~len >> 8));
+        idat.insert(idat.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+    } while (pos < raw.size());
+    writeBE32(idat, (b << 16) | a);
+    writeChunk(file, "IDAT", idat);
+
+    writeChunk(file, "IEND", {});
+    return bool(file);
+}
+
+bool Framebuffer::save(const std::string& path) const {
+    bool isPNG = path.size() >= 4 && path.compare(path.size() - 4, 4, ".png") == 0;
+    return isPNG ? savePNG(path) : savePPM(path);
+}
+
+// ───── Вывод на экран ─────
+
+#if defined(_WIN32)
+void presentFramebuffer(HDC hdc, const Framebuffer& fb, const ScreenRect* rect) {
+    if (fb.width == 0 || fb.height == 0) return;
+    PROFILE_SCOPE(Stage::Present);
+
+    // ✂️ Только полосу строк [y0, y1), а в ней — столбцы [x0, x1)
+    ScreenRect area = { 0, 0, fb.width, fb.height };
+    if (rect) {
+        area = { std::max(rect->x0, 0), std::max(rect->y0, 0), std::min(rect->x1, fb.width), std::min(rect->y1, fb.height) };
+        if (area.empty()) return;
+    }
+    int rows = area.y1 - area.y0;
+
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = fb.width;
+    bmi.bmiHeader.biHeight = -rows; // ⚠️ минус — строки идут сверху вниз
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    // 🖌️ Одним вызовом вместо SetPixel на каждую точку
+    SetDIBitsToDevice(hdc, area.x0, area.y0, area.x1 - area.x0, rows, area.x0, 0, 0, rows,
+                      fb.color.data() + size_t(area.y0) * fb.width, &bmi, DIB_RGB_COLORS);
+}
+#endif
+
+#ifdef ENGINE_HAS_X11
+void presentFramebuffer(Display* display, Window window, GC gc, const Framebuffer& fb, const std::vector<ScreenRect>* rects) {
+    if (fb.width == 0 || fb.height == 0) return;
+    PROFILE_SCOPE(Stage::Present);
+
+    int screen = DefaultScreen(display);
+    XImage* image = XCreateImage(display, DefaultVisual(display, screen), DefaultDepth(display, screen),
+                                 ZPixmap, 0, (char*)fb.color.data(), fb.width, fb.height, 32, 0);
+    if (!image) return;
+
+    if (!rects) {
+        XPutImage(display, window, gc, image, 0, 0, 0, 0, fb.width, fb.height);
+    } else {
+        // ✂️ Только изменившиеся прямоугольники — остальное на экране и так верное
+        for (const ScreenRect& rect : *rects) {
+            int x0 = std::max(rect.x0, 0), y0 = std::max(rect.y0, 0);
+            int x1 = std::min(rect.x1, fb.width), y1 = std::min(rect.y1, fb.height);
+            if (x0 < x1 && y0 < y1)
+                XPutImage(display, window, gc, image, x0, y0, x0, y0, unsigned(x1 - x0), unsigned(y1 - y0));
+        }
+    }
+
+    image->data = nullptr; // ⚠️ память принадлежит Framebuffer — XDestroyImage не должен её освобождать
+    XDestroyImage(image);
+    XFlush(display);
+}
+#endif
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <cfloat>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#endif
+
+// 🎨 Упаковка цвета в 0xAARRGGBB — в памяти это B,G,R,A: ровно то, что ждут GDI (32-bit DIB) и X11 (TrueColor)
+inline uint32_t packRGB(uint8_t r, uint8_t g, uint8_t b) {
+    return 0xFF000000u | (uint32_t(r) << 16) | (uint32_t(g) << 8) | uint32_t(b);
+}
+
+inline uint32_t packRGBA(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    return (uint32_t(a) << 24) | (uint32_t(r) << 16) | (uint32_t(g) << 8) | uint32_t(b);
+}
+
+// 🫧 src поверх dst с прозрачностью alpha (0..255); результат непрозрачный
+inline uint32_t blendOver(uint32_t src, uint32_t dst, uint32_t alpha) {
+    uint32_t inv = 255 - alpha;
+    auto mix = [&](int shift) { return (((src >> shift) & 0xFF) * alpha + ((dst >> shift) & 0xFF) * inv + 127) / 255; };
+    return 0xFF000000u | (mix(16) << 16) | (mix(8) << 8) | mix(0);
+}
+
+// 🔹 opacity модели (0.0 — прозрачный, 1.0 — непрозрачный) → alpha 0..255
+inline uint8_t opacityToAlpha(float opacity) {
+    return opacity >= 1.0f ? 255 : opacity <= 0.0f ? 0 : uint8_t(opacity * 255.0f + 0.5f);
+}
+
+// 📐 Прямоугольник кадра в пикселях: [x0, x1) x [y0, y1)
+struct ScreenRect {
+    int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+
+    bool empty() const { return x0 >= x1 || y0 >= y1; }
+    int64_t area() const { return empty() ? 0 : int64_t(x1 - x0) * int64_t(y1 - y0); }
+    bool intersects(const ScreenRect& other) const {
+        return x0 < other.x1 && other.x0 < x1 && y0 < other.y1 && other.y0 < y1;
+    }
+    void merge(const ScreenRect& other) {
+        if (other.empty()) return;
+        if (empty()) { *this = other; return; }
+        if (other.x0 < x0) x0 = other.x0;
+        if (other.y0 < y0) y0 = other.y0;
+        if (other.x1 > x1) x1 = other.x1;
+        if (other.y1 > y1) y1 = other.y1;
+    }
+};
+
+// 🖼️ Кадровый буфер в памяти: весь кадр рисуется сюда, а на экран уходит одним блитом
+struct Framebuffer {
+    int width = 0;
+    int height = 0;
+    std::vector<uint32_t> color; // строки сверху вниз, width * height пикселей
+    std::vector<float> depth;    // глубина каждого пикселя (меньше — ближе к камере)
+
+    void resize(int w, int h);                                   // ⚠️ содержимое после resize не определено
+    void clear(uint32_t rgb = packRGB(0, 0, 0), float depthValue = FLT_MAX);
+    void clear(const ScreenRect& rect, uint32_t rgb = packRGB(0, 0, 0), float depthValue = FLT_MAX); // ✂️ только rect
+
+    // 🔹 Пиксель без проверки глубины (с проверкой границ)
+    void setPixel(int x, int y, uint32_t rgb) {
+        if (x < 0 || y < 0 || x >= width || y >= height) return;
+        color[size_t(y) * width + x] = rgb;
+    }
+
+    // 🫧 То же с прозрачностью alpha (0..255) — поверх того, что уже в буфере
+    void blendPixel(int x, int y, uint32_t rgb, uint32_t alpha) {
+        if (x < 0 || y < 0 || x >= width || y >= height) return;
+        uint32_t& dst = color[size_t(y) * width + x];
+        dst = blendOver(rgb, dst, alpha);
+    }
+
+    bool savePPM(const std::string& path) const; // 📄 P6, без зависимостей
+    bool savePNG(const std::string& path) const; // 📄 PNG без сжатия (stored deflate), тоже без зависимостей
+    bool save(const std::string& path) const;    // формат по расширению: .png, иначе PPM
+};
+
+// ───── Вывод на экран одним блитом ─────
+#if defined(_WIN32)
+    void presentFramebuffer(HDC hdc, const Framebuffer& fb, const ScreenRect* rect = nullptr); // rect — только его
+#endif
+
+// 🐧 X11-версия — в framebuffer_x11.hpp: Xlib определяет макросы Bool, None, Status...
+// и не должен попадать во все файлы через core.hpp
@@ -0,0 +1,13 @@
+#pragma once
+#include "framebuffer.hpp"
+
+// 🐧 Вывод кадра в окно X11. Подключать только там, где нужен Xlib (main.cpp, framebuffer.cpp)
+#ifdef ENGINE_HAS_X11
+    #include <X11/Xlib.h>
+
+    #include <vector>
+
+    // rects — только эти прямоугольники кадра (nullptr — весь)
+    void presentFramebuffer(Display* display, Window window, GC gc, const Framebuffer& fb,
+                            const std::vector<ScreenRect>* rects = nullptr);
+#endif
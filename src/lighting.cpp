@@ -0,0 +1,373 @@
+// lighting.cpp
+#include "lighting.hpp"
+#include "core.hpp"
+#include "mesh.hpp"
+#include "profiler.hpp"
+#include "raster.hpp"
+#include "scene.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#define DEG2RAD(angleDegrees) ((angleDegrees) * 3.14159265f / 180.0f)
+
+static void normalize3(float v[3]) {
+    float length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    float k = length > 1e-12f ? 1.0f / length : 0.0f;
+    v[0] *= k;
+    v[1] *= k;
+    v[2] *= k;
+}
+
+// ───── Карта теней ─────
+
+void ShadowMap::begin(const float direction[3], const AABB& bounds, int mapSize) {
+    triangles.clear();
+    size = std::max(16, mapSize);
+    tiles = (size + TILE - 1) / TILE;
+
+    // 📐 Базис света: f — вдоль луча, u/v — плоскость карты
+    float f[3] = { direction[0], direction[1], direction[2] };
+    normalize3(f);
+    float up[3] = { 0.0f, 1.0f, 0.0f };
+    if (std::fabs(f[1]) > 0.99f) { up[0] = 1.0f; up[1] = 0.0f; }
+    float u[3] = { up[1] * f[2] - up[2] * f[1], up[2] * f[0] - up[0] * f[2], up[0] * f[1] - up[1] * f[0] };
+    normalize3(u);
+    float v[3] = { f[1] * u[2] - f[2] * u[1], f[2] * u[0] - f[0] * u[2], f[0] * u[1] - f[1] * u[0] };
+
+    // 📦 Подгоняем карту под углы коробки сцены
+    float lo[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, hi[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (int corner = 0; corner < 8; ++corner) {
+        float p[3] = { (corner & 1) ? bounds.max[0] : bounds.min[0],
+                       (corner & 2) ? bounds.max[1] : bounds.min[1],
+                       (corner & 4) ? bounds.max[2] : bounds.min[2] };
+        const float* axes[3] = { u, v, f };
+        for (int k = 0; k < 3; ++k) {
+            float d = axes[k][0] * p[0] + axes[k][1] * p[1] + axes[k][2] * p[2];
+            lo[k] = std::min(lo[k], d);
+            hi[k] = std::max(hi[k], d);
+        }
+    }
+    float extentU = std::max(hi[0] - lo[0], 1e-3f), extentV = std::max(hi[1] - lo[1], 1e-3f);
+    float su = float(size) / extentU, sv = float(size) / extentV;
+    const float m[12] = {
+        u[0] * su, u[1] * su, u[2] * su, -lo[0] * su,
+        v[0] * sv, v[1] * sv, v[2] * sv, -lo[1] * sv,
+        f[0],      f[1],      f[2],      -lo[2],
+    };
+    std::copy(m, m + 12, lightSpace.m);
+
+    // 🔹 Сдвиг против «самозатенения» — полтора текселя в мире
+    bias = 1.5f * std::max(extentU, extentV) / float(size) + 0.5f;
+
+    depth.assign(size_t(size) * size_t(size), FLT_MAX);
+    bins.resize(size_t(tiles) * size_t(tiles));
+    for (auto& bin : bins) bin.clear();
+}
+
+void ShadowMap::addCaster(const Mesh& mesh, const Transform& transform) {
+    const ViewProjection lp = withTransform(lightSpace, transform);
+    size_t count = mesh.pointCount();
+    scratchU.resize(count);
+    scratchV.resize(count);
+    scratchD.resize(count);
+    for (size_t i = 0; i < count; ++i)
+        lp.toView(mesh.x[i], mesh.y[i], mesh.z[i], scratchU[i], scratchV[i], scratchD[i]);
+
+    // 🔺 Полигон — веер треугольников от первой точки; линии и одиночные точки тени не дают
+    for (size_t p = 0; p < mesh.polygonCount(); ++p) {
+        uint32_t begin = mesh.polygonPointBegin(p), end = mesh.polygonPointEnd(p);
+        for (uint32_t i = begin + 1; end - begin >= 3 && i + 1 < end; ++i) {
+            const uint32_t v[3] = { begin, i, i + 1 };
+            Triangle t;
+            float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+            for (int k = 0; k < 3; ++k) {
+                t.x[k] = scratchU[v[k]];
+                t.y[k] = scratchV[v[k]];
+                t.z[k] = scratchD[v[k]];
+                minX = std::min(minX, t.x[k]); maxX = std::max(maxX, t.x[k]);
+                minY = std::min(minY, t.y[k]); maxY = std::max(maxY, t.y[k]);
+            }
+            if (maxX < 0.0f || maxY < 0.0f || minX >= float(size) || minY >= float(size)) continue;
+
+            uint32_t index = uint32_t(triangles.size());
+            triangles.push_back(t);
+            // 🔹 В float зажимаем до перевода в int: вершины у плоскости проекции уходят далеко за карту
+            int tx0 = floorToRange(minX, 0, size - 1) / TILE, ty0 = floorToRange(minY, 0, size - 1) / TILE;
+            int tx1 = floorToRange(maxX, 0, size - 1) / TILE, ty1 = floorToRange(maxY, 0, size - 1) / TILE;
+            for (int ty = ty0; ty <= ty1; ++ty)
+                for (int tx = tx0; tx <= tx1; ++tx)
+                    bins[size_t(ty) * size_t(tiles) + size_t(tx)].push_back(index);
+        }
+    }
+}
+
+void ShadowMap::render(ThreadPool& pool) {
+    pool.parallelFor(bins.size(), [&](size_t tile) { rasterTile(tile); });
+}
+
+// 🧱 Одна плитка: ближайшая глубина по центрам текселей (проекция ортографическая — глубина линейна)
+void ShadowMap::rasterTile(size_t tile) {
+    int x0 = int(tile % size_t(tiles)) * TILE, y0 = int(tile / size_t(tiles)) * TILE;
+    int x1 = std::min(size, x0 + TILE), y1 = std::min(size, y0 + TILE);
+
+    for (uint32_t index : bins[tile]) {
+        const Triangle& t = triangles[index];
+        float area = (t.x[1] - t.x[0]) * (t.y[2] - t.y[0]) - (t.x[2] - t.x[0]) * (t.y[1] - t.y[0]);
+        if (std::fabs(area) < 1e-8f) continue;
+        float invArea = 1.0f / area;
+
+        int bx0 = std::max(x0, floorToRange(std::min({ t.x[0], t.x[1], t.x[2] }), x0 - 1, x1));
+        int by0 = std::max(y0, floorToRange(std::min({ t.y[0], t.y[1], t.y[2] }), y0 - 1, y1));
+        int bx1 = std::min(x1 - 1, ceilToRange(std::max({ t.x[0], t.x[1], t.x[2] }), x0 - 1, x1));
+        int by1 = std::min(y1 - 1, ceilToRange(std::max({ t.y[0], t.y[1], t.y[2] }), y0 - 1, y1));
+
+        for (int y = by0; y <= by1; ++y) {
+            float py = float(y) + 0.5f;
+            float* row = depth.data() + size_t(y) * size_t(size);
+            for (int x = bx0; x <= bx1; ++x) {
+                float px = float(x) + 0.5f;
+                // 🔹 Барицентрические координаты; знак площади не важен — тень от обеих сторон
+                float w0 = ((t.x[1] - px) * (t.y[2] - py) - (t.x[2] - px) * (t.y[1] - py)) * invArea;
+                float w1 = ((t.x[2] - px) * (t.y[0] - py) - (t.x[0] - px) * (t.y[2] - py)) * invArea;
+                float w2 = 1.0f - w0 - w1;
+                if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+                float d = w0 * t.z[0] + w1 * t.z[1] + w2 * t.z[2];
+                if (d < row[x]) row[x] = d;
+            }
+        }
+    }
+}
+
+float ShadowMap::visibility(float u, float v, float d) const {
+    if (depth.empty()) return 1.0f;
+    float fu = u - 0.5f, fv = v - 0.5f;
+    // 🔹 Далеко за картой (и NaN) — всё равно «освещено»; зажим только чтобы int() не переполнился
+    int x = floorToRange(fu, -2, size + 1), y = floorToRange(fv, -2, size + 1);
+    float tx = std::clamp(fu - float(x), 0.0f, 1.0f), ty = std::clamp(fv - float(y), 0.0f, 1.0f);
+    float top = (sample(x, y, d) ? 1.0f - tx : 0.0f) + (sample(x + 1, y, d) ? tx : 0.0f);
+    float bottom = (sample(x, y + 1, d) ? 1.0f - tx : 0.0f) + (sample(x + 1, y + 1, d) ? tx : 0.0f);
+    return top * (1.0f - ty) + bottom * ty;
+}
+
+// ───── Освещение ─────
+
+struct Lighting::ModelSpace {
+    float eye[3];                  // камера
+    float sun[3];                  // единичный вектор К солнцу
+    float radiusScale;             // 1 / радиус источника², в единицах модели
+    ViewProjection shadow;         // точка модели → карта теней
+    bool shadowed = false;
+    size_t lightCount = 0;
+    float lx[MAX_POINT_LIGHTS], ly[MAX_POINT_LIGHTS], lz[MAX_POINT_LIGHTS];
+    float lr[MAX_POINT_LIGHTS], lg[MAX_POINT_LIGHTS], lb[MAX_POINT_LIGHTS];
+    LightTargetId target[MAX_POINT_LIGHTS];
+};
+
+void Lighting::beginFrame(const Camera& camera) {
+    eye[0] = camera.x;
+    eye[1] = camera.y;
+    eye[2] = camera.z;
+    lights.clear();
+    shadowsReady = false;
+}
+
+void Lighting::prepareScene(const Scene& scene, const Transform* transforms, ThreadPool& pool) {
+    const auto& instances = scene.instances;
+    auto transformOf = [&](size_t i) -> const Transform& { return transforms ? transforms[i] : instances[i].transform; };
+
+    lights.clear();
+    shadowsReady = false;
+    AABB world;
+    bool anyCaster = false;
+
+    for (size_t i = 0; i < instances.size(); ++i) {
+        const Mesh* mesh = instances[i].mesh.get();
+        if (!mesh || mesh->pointCount() == 0) continue;
+        const Transform& t = transformOf(i);
+        if (!mesh->bounds.empty()) world.expand(transformBounds(mesh->bounds, t));
+        anyCaster = anyCaster || mesh->castShadow;
+
+        // 🔆 Светящиеся точки → мировые источники (тот же сдвиг/поворот/масштаб, что у withTransform)
+        if (mesh->emitters.empty()) continue;
+        float a = DEG2RAD(-t.rotationY);
+        float c = std::cos(a) * t.scale, s = std::sin(a) * t.scale;
+        for (const Emitter& e : mesh->emitters) {
+            float x = mesh->x[e.point], y = mesh->y[e.point], z = mesh->z[e.point];
+            float k = mesh->lightIntensity[e.point] / 255.0f;
+            lights.push_back({ c * x + s * z + t.x, t.scale * y + t.y, -s * x + c * z + t.z,
+                               float(mesh->r[e.point]) * k, float(mesh->g[e.point]) * k, float(mesh->b[e.point]) * k,
+                               e.target });
+        }
+    }
+
+    if (lights.size() > MAX_POINT_LIGHTS) {
+        auto brightness = [](const PointLight& l) { return l.r + l.g + l.b; };
+        std::nth_element(lights.begin(), lights.begin() + MAX_POINT_LIGHTS, lights.end(),
+                         [&](const PointLight& a, const PointLight& b) { return brightness(a) > brightness(b); });
+        lights.resize(MAX_POINT_LIGHTS);
+    }
+
+    if (!settings.shadows || !anyCaster || world.empty()) return;
+
+    PROFILE_SCOPE(Stage::Shadow);
+    shadows.begin(settings.sunDirection, world, settings.shadowMapSize);
+    for (size_t i = 0; i < instances.size(); ++i) {
+        const Mesh* mesh = instances[i].mesh.get();
+        if (mesh && mesh->castShadow) shadows.addCaster(*mesh, transformOf(i));
+    }
+    shadows.render(pool);
+    shadowsReady = true;
+}
+
+void Lighting::shade(const Mesh& mesh, const Transform& transform, const uint32_t* polygons, size_t polygonCount,
+                     uint32_t* out) const {
+    PROFILE_SCOPE(Stage::Shade);
+
+    // 🧭 Мир → модель: p = Rᵀ(p_мир − сдвиг) / масштаб; направления — только поворот
+    float a = DEG2RAD(-transform.rotationY);
+    float c = std::cos(a), s = std::sin(a);
+    float invScale = transform.scale != 0.0f ? 1.0f / transform.scale : 1.0f;
+    auto toModel = [&](float x, float y, float z, float* p) {
+        x -= transform.x;
+        y -= transform.y;
+        z -= transform.z;
+        p[0] = (c * x - s * z) * invScale;
+        p[1] = y * invScale;
+        p[2] = (s * x + c * z) * invScale;
+    };
+
+    ModelSpace space;
+    toModel(eye[0], eye[1], eye[2], space.eye);
+    float sun[3] = { -settings.sunDirection[0], -settings.sunDirection[1], -settings.sunDirection[2] };
+    normalize3(sun);
+    space.sun[0] = c * sun[0] - s * sun[2];
+    space.sun[1] = sun[1];
+    space.sun[2] = s * sun[0] + c * sun[2];
+    float radius = std::max(settings.pointLightRadius * invScale, 1e-3f);
+    space.radiusScale = 1.0f / (radius * radius);
+    space.shadowed = shadowsReady;
+    if (shadowsReady) space.shadow = withTransform(shadows.light(), transform);
+    for (const PointLight& light : lights) {
+        size_t k = space.lightCount++;
+        float p[3];
+        toModel(light.x, light.y, light.z, p);
+        space.lx[k] = p[0];
+        space.ly[k] = p[1];
+        space.lz[k] = p[2];
+        space.lr[k] = light.r;
+        space.lg[k] = light.g;
+        space.lb[k] = light.b;
+        space.target[k] = light.target;
+    }
+
+    if (polygons) {
+        for (size_t k = 0; k < polygonCount; ++k)
+            shadePolygon(space, mesh, polygons[k], out);
+        return;
+    }
+
+    for (size_t p = 0; p < mesh.polygonCount(); ++p)
+        shadePolygon(space, mesh, uint32_t(p), out);
+    // 🔹 Линии и точки вне полигонов — без материала, свой цвет
+    size_t tail = mesh.polygonCount() ? mesh.polygonPointEnd(mesh.polygonCount() - 1) : 0;
+    for (size_t i = tail; i < mesh.pointCount(); ++i)
+        out[i] = packRGB(mesh.r[i], mesh.g[i], mesh.b[i]);
+}
+
+void Lighting::shadePolygon(const ModelSpace& space, const Mesh& mesh, uint32_t polygon, uint32_t* out) const {
+    uint32_t begin = mesh.polygonPointBegin(polygon), end = mesh.polygonPointEnd(polygon);
+    if (begin == end) return;
+
+    const Material& material = mesh.materials[mesh.polygonMaterial[polygon]];
+    float nx = mesh.normalX[polygon], ny = mesh.normalY[polygon], nz = mesh.normalZ[polygon];
+    if (material.type != LightType::Lit || (nx == 0.0f && ny == 0.0f && nz == 0.0f)) {
+        // 💡 Без освещения: неосвещаемые, светящиеся сами и полигоны без нормали (линии, точки)
+        for (uint32_t i = begin; i < end; ++i)
+            out[i] = packRGB(mesh.r[i], mesh.g[i], mesh.b[i]);
+        return;
+    }
+
+    // 🔹 Двусторонние полигоны: нормаль — к камере
+    if (nx * (space.eye[0] - mesh.x[begin]) + ny * (space.eye[1] - mesh.y[begin]) + nz * (space.eye[2] - mesh.z[begin]) < 0.0f) {
+        nx = -nx;
+        ny = -ny;
+        nz = -nz;
+    }
+
+    // 🎨 Общее на полигон: солнце, доли диффузного/зеркального, нормировка блика
+    const float sunLight = std::max(0.0f, nx * space.sun[0] + ny * space.sun[1] + nz * space.sun[2]) * settings.sunIntensity;
+    const float diffuse = 1.0f - material.metallic;
+    const float shininess = material.shininess;
+    const float specNorm = (shininess + 8.0f) / (8.0f * 3.14159265f) * sunLight;
+    const float f0 = 0.04f * (1.0f - material.metallic); // ✨ диэлектрик — 4% белым, металл — своим цветом
+
+    size_t lightIndex[MAX_POINT_LIGHTS];
+    size_t lightCount = 0;
+    for (size_t k = 0; k < space.lightCount; ++k)
+        if (space.target[k] == LIGHT_TARGET_ALL || material.target == LIGHT_TARGET_ALL || space.target[k] == material.target)
+            lightIndex[lightCount++] = k;
+
+    const float* px = mesh.x.data();
+    const float* py = mesh.y.data();
+    const float* pz = mesh.z.data();
+
+    for (uint32_t first = begin; first < end; first += uint32_t(BATCH)) {
+        const size_t n = std::min<size_t>(BATCH, end - first);
+        float spec[BATCH], sunVis[BATCH], dr[BATCH], dg[BATCH], db[BATCH];
+
+        // ✨ Блик солнца: полувектор между направлением к солнцу и к камере
+        for (size_t i = 0; i < n; ++i) {
+            float vx = space.eye[0] - px[first + i], vy = space.eye[1] - py[first + i], vz = space.eye[2] - pz[first + i];
+            float inv = 1.0f / std::sqrt(vx * vx + vy * vy + vz * vz + 1e-12f);
+            float hx = space.sun[0] + vx * inv, hy = space.sun[1] + vy * inv, hz = space.sun[2] + vz * inv;
+            float hinv = 1.0f / std::sqrt(hx * hx + hy * hy + hz * hz + 1e-12f);
+            spec[i] = std::max(0.0f, (nx * hx + ny * hy + nz * hz) * hinv);
+        }
+        for (size_t i = 0; i < n; ++i)
+            spec[i] = std::pow(spec[i], shininess) * specNorm;
+
+        // 🌑 Тень солнца
+        for (size_t i = 0; i < n; ++i) sunVis[i] = 1.0f;
+        if (space.shadowed && sunLight > 0.0f) {
+            for (size_t i = 0; i < n; ++i) {
+                float u, v, d;
+                space.shadow.toView(px[first + i], py[first + i], pz[first + i], u, v, d);
+                sunVis[i] = shadows.visibility(u, v, d);
+            }
+        }
+
+        // 🔆 Точечные источники: диффузно, затухание 1 / (1 + d²/r²)
+        for (size_t i = 0; i < n; ++i) dr[i] = dg[i] = db[i] = 0.0f;
+        for (size_t k = 0; k < lightCount; ++k) {
+            size_t l = lightIndex[k];
+            const float lx = space.lx[l], ly = space.ly[l], lz = space.lz[l];
+            const float lr = space.lr[l], lg = space.lg[l], lb = space.lb[l];
+            for (size_t i = 0; i < n; ++i) {
+                float x = lx - px[first + i], y = ly - py[first + i], z = lz - pz[first + i];
+                float d2 = x * x + y * y + z * z;
+                float ndl = std::max(0.0f, (nx * x + ny * y + nz * z) / std::sqrt(d2 + 1e-12f));
+                float w = ndl / (1.0f + d2 * space.radiusScale);
+                dr[i] += w * lr;
+                dg[i] += w * lg;
+                db[i] += w * lb;
+            }
+        }
+
+        // 🧮 Итог: свой цвет × (окружение + диффузное) + блик + собственное свечение точки
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t p = first + uint32_t(i);
+            float sunDiffuse = sunLight * sunVis[i];
+            float highlight = spec[i] * sunVis[i];
+            float glow = settings.ambient + mesh.lightIntensity[p];
+            float r = mesh.r[p], g = mesh.g[p], b = mesh.b[p];
+            float outR = r * (glow + diffuse * (sunDiffuse + dr[i])) + (f0 * 255.0f + material.metallic * r) * highlight;
+            float outG = g * (glow + diffuse * (sunDiffuse + dg[i])) + (f0 * 255.0f + material.metallic * g) * highlight;
+            float outB = b * (glow + diffuse * (sunDiffuse + db[i])) + (f0 * 255.0f + material.metallic * b) * highlight;
+            out[p] = packRGB(uint8_t(std::min(255.0f, outR + 0.5f)), uint8_t(std::min(255.0f, outG + 0.5f)),
+                             uint8_t(std::min(255.0f, outB + 0.5f)));
+        }
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "bvh.hpp"
+#include "material.hpp"
+#include "projection.hpp"
+
+struct Camera;    // 🎥 см. core.hpp
+struct Transform; // 🧭 см. core.hpp
+struct Mesh;      // 📦 см. mesh.hpp
+class Scene;      // 🌍 см. scene.hpp
+class ThreadPool;
+
+// 💡 Настройки освещения. Выключено по умолчанию — тогда цвета точек идут в кадр как есть
+struct LightingSettings {
+    bool enabled = false;
+    float sunDirection[3] = { -0.4f, -1.0f, 0.3f }; // ☀️ куда светит солнце (нормализуется)
+    float sunIntensity = 1.0f;
+    float ambient = 0.25f;          // 🌫️ окружение — освещено всё, даже в тени
+    bool shadows = true;            // 🌑 карта теней от моделей с castShadow
+    int shadowMapSize = 1024;       // текселей по стороне
+    float pointLightRadius = 300.0f; // см: на таком расстоянии точечный источник светит вполовину
+};
+
+// 🔆 Точечный источник кадра — в мировых координатах
+struct PointLight {
+    float x, y, z;
+    float r, g, b;        // цвет × lightIntensity (1 — белый в полную силу)
+    LightTargetId target;
+};
+
+// 🌑 Карта теней солнца: ортографическая проекция вдоль луча, подогнанная под коробку сцены.
+// Треугольники отбрасывающих тень моделей раскладываются по плиткам, плитки растеризуются параллельно
+class ShadowMap {
+public:
+    // 📐 Новый кадр: направление луча, мировая коробка всего, что может попасть в тень
+    void begin(const float direction[3], const AABB& bounds, int size);
+    void addCaster(const Mesh& mesh, const Transform& transform); // 🔺 полигоны модели — веером
+    void render(ThreadPool& pool);
+
+    // 🔹 Мир → (u, v в текселях, глубина вдоль луча в см); для модели — withTransform(light(), transform)
+    const ViewProjection& light() const { return lightSpace; }
+
+    // 🌗 Доля света в точке (0 — в тени, 1 — освещена), 2x2 PCF со сглаживанием по текселю
+    float visibility(float u, float v, float depth) const;
+
+    bool empty() const { return depth.empty(); }
+    size_t casterCount() const { return triangles.size(); } // треугольников в последнем кадре
+
+private:
+    static constexpr int TILE = 64;
+
+    struct Triangle {
+        float x[3], y[3], z[3];
+    };
+
+    bool sample(int x, int y, float d) const {
+        if (x < 0 || y < 0 || x >= size || y >= size) return true;
+        return d - bias <= depth[size_t(y) * size_t(size) + size_t(x)];
+    }
+    void rasterTile(size_t tile);
+
+    ViewProjection lightSpace;
+    int size = 0, tiles = 0;
+    float bias = 0.0f;
+    std::vector<float> depth;
+    std::vector<Triangle> triangles;
+    std::vector<std::vector<uint32_t>> bins; // треугольники по плиткам
+    std::vector<float> scratchU, scratchV, scratchD;
+};
+
+// ☀️ Освещение точек на CPU: окружение + солнце с тенью + точечные источники, блик по Блинну–Фонгу.
+// Считается при отправке модели в растеризатор, пачками по BATCH точек одного полигона:
+// материал и нормаль на пачку общие, а циклы по точкам — простые и векторизуются компилятором.
+// Свет, камера и карта теней переводятся в координаты модели один раз на экземпляр — точки не трогаются
+class Lighting {
+public:
+    static constexpr size_t MAX_POINT_LIGHTS = 16; // 🔹 ярчайшие из светящихся точек сцены
+    static constexpr size_t BATCH = 16;
+
+    LightingSettings settings;
+
+    void beginFrame(const Camera& camera); // 📐 камера кадра; источники и тени прошлой сцены сбрасываются
+    // 🌍 Источники из светящихся полигонов сцены и карта теней (transforms — как у App::drawScene)
+    void prepareScene(const Scene& scene, const Transform* transforms, ThreadPool& pool);
+
+    // 🎨 Освещённые цвета 0xRRGGBB в out[точка] — для точек перечисленных полигонов
+    // (polygons == nullptr — для всех точек модели; точки вне полигонов — свой цвет)
+    void shade(const Mesh& mesh, const Transform& transform, const uint32_t* polygons, size_t polygonCount,
+               uint32_t* out) const;
+
+    size_t pointLightCount() const { return lights.size(); }
+    const ShadowMap& shadowMap() const { return shadows; }
+
+private:
+    struct ModelSpace; // свет, камера и карта теней в координатах одной модели
+    void shadePolygon(const ModelSpace& space, const Mesh& mesh, uint32_t polygon, uint32_t* out) const;
+
+    float eye[3] = { 0.0f, 0.0f, 0.0f };
+    std::vector<PointLight> lights;
+    ShadowMap shadows;
+    bool shadowsReady = false;
+};
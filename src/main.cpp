@@ -1,21 +1,345 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
-//#include <thread>
+#include <string>
+#include <vector>
 #include "core.hpp"
+#include "damage.hpp"
+#include "frame_pipeline.hpp"
+#include "mesh.hpp"
+#include "profiler.hpp"
+#include "scene.hpp"
+#include "thread_pool.hpp"
+#include "framebuffer_x11.hpp"
 
 #if defined(_WIN32)  // Если Windows
     #include <windows.h>
 
 #elif defined(__linux__)  // Если Linux
-    //#include <X11/Xlib.h>
-    #error "This operating system is not supported yet."
+    // 🐧 X11 подключается через framebuffer_x11.hpp (ENGINE_HAS_X11), без него — только headless
+    #include <fcntl.h>
+    #include <sys/select.h>
+    #include <unistd.h>
 
 #else
     #error "This operating system is not supported yet."
 #endif
 
 App app;
-int main() {
-    
+static Scene scene; // 🌍 Экземпляры моделей; положение первого сценарии видят как model.*
+static SceneLoader sceneLoad; // 🚚 Файлы сцены грузятся задачами пула, экземпляры оживают по мере готовности
+static std::chrono::steady_clock::time_point sceneLoadStart;
+
+// 🧵 Сценарии и анимации — на своём потоке; рендер берёт только готовые снимки
+static SimulationLoop simulation;
+
+// 🩹 Что изменилось с прошлого нарисованного кадра — неизменный кадр не рисуется, сдвинутое — только своё место
+static DamageTracker damageTracker;
+static FrameDamage frameDamage;
+
+// 🔔 Будильник цикла окна: новый снимок симуляции или загруженная модель сцены
+#if defined(_WIN32)
+static HANDLE frameReady = NULL; // событие для MsgWaitForMultipleObjects
+
+static void openRenderWake() { frameReady = CreateEvent(NULL, FALSE, FALSE, NULL); }
+static void wakeRender() { SetEvent(frameReady); }
+#else
+static int wakePipe[2] = { -1, -1 }; // байт в pipe — select() в цикле X11 просыпается
+
+static void openRenderWake() {
+    if (pipe(wakePipe) != 0) return;
+    fcntl(wakePipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(wakePipe[1], F_SETFL, O_NONBLOCK);
+}
+static void wakeRender() {
+    if (wakePipe[1] < 0) return;
+    char byte = 1;
+    ssize_t ignored = write(wakePipe[1], &byte, 1); // полный pipe — рендер и так уже разбужен
+    (void)ignored;
+}
+#endif
+
+#if defined(_WIN32)
+// 🩹 Пометить для WM_PAINT только испорченные прямоугольники последнего кадра
+static void invalidateDamage(HWND hwnd) {
+    if (frameDamage.full) {
+        InvalidateRect(hwnd, NULL, FALSE);
+        return;
+    }
+    for (const ScreenRect& rect : frameDamage.rects) {
+        RECT area = { rect.x0, rect.y0, rect.x1, rect.y1 };
+        InvalidateRect(hwnd, &area, FALSE);
+    }
+}
+#endif
+
+// 📸 Состояние симуляции → снимок для рендера (после первого кадра без выделений памяти)
+static void captureSnapshot(FrameSnapshot& out) {
+    out.camera = cam;
+    out.transforms.resize(scene.instances.size());
+    for (size_t i = 0; i < scene.instances.size(); ++i)
+        out.transforms[i] = scene.instances[i].transform;
+}
+
+// 🧵 Поток симуляции нужен, только если сцене есть чем двигаться: сценарии или проигрываемые клипы.
+// Иначе снимок один (initial), и рендер просыпается лишь от окна и загрузки моделей
+static bool needsSimulation() {
+    return !app.scripts.empty() || app.animations.playing();
+}
+
+static void simulationStep(FrameSnapshot& out) {
+    app.animate();
+    scene.applyAnimations(app.animations);
+    captureSnapshot(out);
+}
+
+// ⏱️ Часы — с нуля прямо перед стартом: иначе первый шаг получит всё время запуска и загрузки
+static void startSimulation(const FrameSnapshot& initial) {
+    app.resetClock();
+    simulation.start(initial, simulationStep, wakeRender);
+}
+
+// 🎬 Рисуем кадр в app.frame — только по снимку, глобальные cam и положения экземпляров не читаются.
+// Перерисовывается лишь испорченное (frameDamage); false — ничего не изменилось, кадр прежний
+static bool renderSnapshot(const FrameSnapshot& snapshot) {
+    const Transform* transforms = snapshot.transforms.size() == scene.instances.size() ? snapshot.transforms.data() : nullptr;
+    app.beginFrame(snapshot.camera);
+    if (!damageTracker.update(app.view, windowWidth, windowHeight, app.raster.tileSize(),
+                              scene, transforms, app.lighting.settings.enabled, frameDamage))
+        return false;
+
+    app.clear(app.frame, &frameDamage);
+    app.drawScene(scene, transforms, &frameDamage);
+    app.endFrame(app.frame, &frameDamage);
+    return true;
+}
+
+// 🧩 count копий одной модели сеткой по XZ с шагом в полторы коробки модели.
+// Шаг зависит от коробки — поэтому модель грузится сразу, на этом потоке
+static void buildGrid(const std::string& modelPath, int count) {
+    std::shared_ptr<const Mesh> mesh = app.assets.load(modelPath);
+    const AABB& box = mesh->bounds;
+    float stepX = box.empty() ? 100.0f : std::max(1.0f, 1.5f * (box.max[0] - box.min[0]));
+    float stepZ = box.empty() ? 100.0f : std::max(1.0f, 1.5f * (box.max[2] - box.min[2]));
+    int side = int(std::ceil(std::sqrt(double(count))));
+
+    scene.instances.reserve(size_t(count));
+    for (int i = 0; i < count; ++i) {
+        Transform transform;
+        transform.x = float(i % side) * stepX;
+        transform.z = float(i / side) * stepZ;
+        scene.add(mesh, transform);
+    }
+    std::cout << "Instances: " << count << " of " << scene.uniqueMeshCount() << " mesh(es)\n";
+}
+
+// 🌍 Сцена: манифест (--scene), копии сеткой (--instances) или одна модель (--model).
+// Экземпляры создаются сразу (сценарии к ним привязываются), а файлы грузятся в фоне —
+// окно открывается, не дожидаясь разбора, и модели появляются по мере готовности
+static bool buildScene(const std::string& scenePath, const std::string& modelPath, int count) {
+    std::vector<SceneEntry> entries;
+    std::vector<SceneClip> clips;
+    if (!scenePath.empty()) {
+        std::string error;
+        if (!readSceneManifest(scenePath, entries, clips, error)) {
+            std::cerr << "Failed to load scene " << scenePath << ": " << error << '\n';
+            return false;
+        }
+    } else if (count > 1) {
+        buildGrid(modelPath, count);
+        return true;
+    } else {
+        SceneEntry entry;
+        entry.path = modelPath; // 🔹 остальное — по умолчанию: без сдвига, оттенка и анимации
+        entries.push_back(entry);
+    }
+
+    sceneLoadStart = std::chrono::steady_clock::now();
+    size_t firstInstance = scene.instances.size();
+    sceneLoad.start(scene, entries, app.assets, threadPool(),
+                    [](const std::string&, const std::shared_ptr<const Mesh>&) { wakeRender(); });
+
+    // 🎬 Клипы и объекты анимации — до сценариев: те ссылаются на экземпляры по имени
+    scene.bindAnimations(firstInstance, entries, clips, app.animations, &app.scriptBindings);
+    if (!clips.empty())
+        std::cout << "Animations: " << clips.size() << " clip(s), " << scene.animated.size() << " animated instance(s)\n";
+    return true;
+}
+
+// 📜 Сценарии компилируются после привязки модели — имена в них разрешаются при загрузке.
+// Адрес положения должен жить, пока идут сценарии: сцена к этому моменту уже собрана
+static bool loadScripts(const std::vector<std::string>& paths) {
+    if (!scene.instances.empty())
+        app.scriptBindings.bindTransform("model", scene.instances[0].transform);
+    bool ok = true;
+    for (const auto& path : paths)
+        ok = app.loadScript(path) && ok;
+    return ok;
+}
+
+// ⏱️ --profile: сохранить трассу и напечатать p50/p99 по стадиям.
+// Кадры закрывает поток рендера (nextFrame после вывода) — недорисованный хвост в статистику не идёт
+static void finishProfile(const std::string& tracePath) {
+    if (tracePath.empty()) return;
+    if (profiler().exportChromeTrace(tracePath))
+        std::cout << "Profile trace saved: " << tracePath << "\n";
+    else
+        std::cerr << "Failed to write profile trace: " << tracePath << '\n';
+    std::cout << profiler().statsReport();
+}
+
+// 🖥️ Без окна: кадры в файл (PPM или PNG) — для серверов сборки и регрессионных тестов.
+// frames > 1 — сценарии и анимации идут с шагом 1/60 с, сохраняется последний кадр
+static int runHeadless(const std::string& outPath, int frames) {
+    app.setDPI(96);
+
+    // ⏳ Кадр должен быть полным — ждём все файлы сцены
+    sceneLoad.wait();
+    sceneLoad.poll();
+    if (sceneLoad.fileCount() > 1) {
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sceneLoadStart).count();
+        std::cout << "Scene loaded: " << sceneLoad.fileCount() << " files, " << scene.instances.size()
+                  << " instances in " << ms << " ms\n";
+    }
+
+    // 🔹 Без потоков: шаг фиксированный, кадры повторяемые
+    FrameSnapshot snapshot;
+    int redrawn = 0;
+    profiler().nextFrame(); // ⏱️ открыть первый кадр: загрузка сцены в него не входит
+    for (int i = 0; i < frames; ++i) {
+        app.animate(i == 0 ? 0.0f : 1.0f / 60.0f);
+        scene.applyAnimations(app.animations);
+        captureSnapshot(snapshot);
+        redrawn += renderSnapshot(snapshot) ? 1 : 0;
+        profiler().nextFrame(); // 🔹 вывода на экран нет — кадр кончается готовым буфером
+    }
+    if (frames > 1)
+        std::cout << "Frames redrawn: " << redrawn << " of " << frames << "\n";
+
+    if (!app.frame.save(outPath)) {
+        std::cerr << "Failed to write frame: " << outPath << '\n';
+        return 1;
+    }
+    std::cout << "Frame saved: " << outPath << " (" << app.frame.width << "x" << app.frame.height << ")\n";
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    // ───── Аргументы командной строки ─────
+    std::string modelPath = "../data/3d/cube.json";
+    std::string scenePath;
+    std::string headlessOut;
+    bool headless = false;
+    std::vector<std::string> bakeList;
+    std::vector<std::string> scriptList;
+    int headlessFrames = 1;
+    int instanceCount = 1;
+    std::string profilePath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--headless") {
+            headless = true;
+            headlessOut = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : "frame.ppm";
+        } else if (arg == "--size" && i + 1 < argc) {
+            // формат: 1280x720
+            if (sscanf(argv[++i], "%dx%d", &windowWidth, &windowHeight) != 2) {
+                std::cerr << "Bad --size, expected WxH\n";
+                return 1;
+            }
+        } else if (arg == "--camera" && i + 1 < argc) {
+            // формат: x,y,z[,horizontalAngle,verticalAngle] — см и градусы
+            if (sscanf(argv[++i], "%f,%f,%f,%f,%f", &cam.x, &cam.y, &cam.z, &cam.horizontalAngle, &cam.verticalAngle) < 3) {
+                std::cerr << "Bad --camera, expected x,y,z[,h,v]\n";
+                return 1;
+            }
+        } else if (arg == "--model" && i + 1 < argc) {
+            modelPath = argv[++i];
+        } else if (arg == "--scene" && i + 1 < argc) {
+            scenePath = argv[++i]; // 🌍 манифест: много моделей, грузятся параллельно
+        } else if (arg == "--fill") {
+            app.raster.settings.filled = true;   // 🔷 залитые полигоны
+        } else if (arg == "--transparency" && i + 1 < argc) {
+            // 🫧 sorted — точно (сортировка по глубине), blended — быстрее, без сортировки; off — opacity не учитывать
+            std::string mode = argv[++i];
+            if (mode == "sorted") app.raster.settings.transparency = Transparency::Sorted;
+            else if (mode == "blended") app.raster.settings.transparency = Transparency::WeightedBlended;
+            else if (mode == "off") app.raster.settings.transparency = Transparency::Opaque;
+            else {
+                std::cerr << "Bad --transparency, expected sorted|blended|off\n";
+                return 1;
+            }
+        } else if (arg == "--light" && i + 1 < argc) {
+            // ☀️ Включить освещение: направление солнца (куда светит) и, по желанию, его сила
+            LightingSettings& light = app.lighting.settings;
+            if (sscanf(argv[++i], "%f,%f,%f,%f", &light.sunDirection[0], &light.sunDirection[1], &light.sunDirection[2],
+                       &light.sunIntensity) < 3) {
+                std::cerr << "Bad --light, expected dx,dy,dz[,intensity]\n";
+                return 1;
+            }
+            light.enabled = true;
+        } else if (arg == "--ambient" && i + 1 < argc) {
+            app.lighting.settings.ambient = std::max(0.0f, float(atof(argv[++i])));
+        } else if (arg == "--no-shadows") {
+            app.lighting.settings.shadows = false;
+        } else if (arg == "--no-wireframe") {
+            app.raster.settings.wireframe = false;
+        } else if (arg == "--no-cache") {
+            app.useMeshCache = false;
+        } else if (arg == "--script" && i + 1 < argc) {
+            scriptList.push_back(argv[++i]);
+        } else if (arg == "--frames" && i + 1 < argc) {
+            headlessFrames = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--instances" && i + 1 < argc) {
+            instanceCount = std::max(1, atoi(argv[++i])); // 🧩 копии модели сеткой, геометрия общая
+        } else if (arg == "--profile" && i + 1 < argc) {
+            profilePath = argv[++i];
+            profiler().setEnabled(true); // ⏱️ трасса Chrome (chrome://tracing) + p50/p99 в конце
+        } else if (arg == "--bake") {
+            // 💾 Все следующие аргументы без "--" — JSON-модели для запекания
+            while (i + 1 < argc && argv[i + 1][0] != '-')
+                bakeList.push_back(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--model file.json|file.mesh] [--scene scene.json] [--size WxH] [--camera x,y,z[,h,v]] [--headless [out.ppm|out.png]] [--fill] [--transparency sorted|blended|off] [--light dx,dy,dz[,i]] [--ambient a] [--no-shadows] [--no-wireframe] [--no-cache] [--script file]... [--frames N] [--instances N] [--profile trace.json]\n"
+                      << "       " << argv[0] << " --bake model.json...\n";
+            return 1;
+        }
+    }
+
+    // 💾 Режим конвертера: только собрать кэши и выйти
+    if (!bakeList.empty()) {
+        bool ok = true;
+        for (const auto& path : bakeList)
+            ok = app.bake(path) && ok;
+        return ok ? 0 : 1;
+    }
+
+#if defined(__linux__) && !defined(ENGINE_HAS_X11)
+    if (!headless) {
+        std::cout << "Built without X11, rendering headless\n";
+        headless = true;
+        headlessOut = "frame.ppm";
+    }
+#endif
+
+    std::cout << "Camera: (" << cam.x << ", " << cam.y << ", " << cam.z << "), horizontal angle: "<< cam.horizontalAngle << ", vertical angle: "<< cam.verticalAngle << "\n";
+
+    if (!headless)
+        openRenderWake();
+    if (!buildScene(scenePath, modelPath, instanceCount))
+        return 1;
+    if (!loadScripts(scriptList))
+        return 1;
+
+    if (headless) {
+        int result = runHeadless(headlessOut, headlessFrames);
+        finishProfile(profilePath);
+        return result;
+    }
+
 #if defined(_WIN32)
     // 🔹 Название класса окна
     const wchar_t CLASS_NAME[] = L"MyWinWindowClass";
@@ -34,7 +358,7 @@ int main() {
         CLASS_NAME,                 // Класс окна
         L"3d-script-engine",         // Заголовок окна
         WS_OVERLAPPEDWINDOW,        // Стиль (обычное окно)
-        CW_USEDEFAULT, CW_USEDEFAULT, 640, 480, // Положение и размер
+        CW_USEDEFAULT, CW_USEDEFAULT, windowWidth, windowHeight, // Положение и размер
         NULL, NULL, wc.hInstance, NULL // Родитель, меню и т.п.
     );
 
@@ -44,43 +368,53 @@ int main() {
     int dpi = GetDeviceCaps(screen, LOGPIXELSX);
     ReleaseDC(hwnd, screen);
 
-    //std::thread inputThread(&App:: , &app);
+    app.setDPI(dpi); // считается один раз в начале программы
 
-    app.scale = dpi / 2.54f * focalLengthMM / 10.0f; // считается один раз в начале программы
+    FrameSnapshot initial;
+    captureSnapshot(initial);
+    sceneLoad.poll(); // 🔹 что успело загрузиться, пока создавалось окно
+    renderSnapshot(initial);
+    InvalidateRect(hwnd, NULL, FALSE); // 🔹 Кадр попадёт на экран в WM_PAINT (там же и закроется кадр профайлера)
 
-    std::cout << "Camera: (" << cam.x << ", " << cam.y << ", " << cam.z << "), horizontal angle: "<< cam.horizontalAngle << ", vertical angle: "<< cam.verticalAngle << "\n";
-    Model model = app.loader("../data/3d/cube.json");
-    HDC hdc = GetDC(hwnd);         // 🔹 Получаем доступ к окну
-    for (const auto& polygon : model.polygons) {
-        for (const auto& line : polygon.lines) {
-            for (const auto& point : line.points) {
-                app.draw3DPoint(hdc, point);       // 🔹 Рисуем что-то
-                std::cout << "Point: (" << point.x << ", " << point.y << ", " << point.z << ")\n";
-            }
-        }
-    }
-    ReleaseDC(hwnd, hdc);          // 🔹 Отпускаем, освобождаем ресурс
+    // 🧵 Есть сценарии или анимации — симуляция идёт на своём потоке и сигналит событием о каждом снимке
+    if (needsSimulation())
+        startSimulation(initial);
 
-    // 🔁 Запускаем цикл, который реагирует на события И выполняет свою логику
+    // 🔁 Спим, пока нет сообщений окна, нового снимка или загруженной модели — ядро не крутится впустую
     MSG msg = {};
-    while (true) {
-        if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
-            if (msg.message == WM_QUIT)
+    bool running = true;
+    while (running) {
+        MsgWaitForMultipleObjects(1, &frameReady, FALSE, INFINITE, QS_ALLINPUT);
+
+        while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
+            if (msg.message == WM_QUIT) {
+                running = false;
                 break;
+            }
             TranslateMessage(&msg);
             DispatchMessage(&msg);
-        } else {
-            // здесь бесконечно что-то выполняется
+        }
+        if (!running) break;
+
+        // 🖼️ Новый снимок, новые модели сцены или новый размер окна (WM_SIZE) — рисуем самый свежий снимок,
+        // если в нём что-то изменилось, и отдаём в WM_PAINT только испорченные прямоугольники
+        bool fresh = simulation.acquire();
+        bool loaded = sceneLoad.poll() > 0;
+        if (fresh || loaded || app.frame.width != windowWidth || app.frame.height != windowHeight) {
+            if (renderSnapshot(simulation.running() ? simulation.latest() : initial))
+                invalidateDamage(hwnd);
         }
     }
-    //inputThread.join();      // 🧵 Дождись завершения waitForLine()
+    simulation.stop();
+    sceneLoad.wait(); // ⚠️ задачи загрузки ещё могут дёрнуть wakeRender()
+    CloseHandle(frameReady);
 
 
-#elif defined(__linux__)
+#elif defined(ENGINE_HAS_X11)
     // 🔹 Открываем соединение с X-сервером
     Display* display = XOpenDisplay(NULL);
     if (!display) {
-        std::cerr << "Failed to connect to X server\n";
+        std::cerr << "Failed to connect to X server (use --headless)\n";
         return 1;
     }
 
@@ -93,11 +427,12 @@ int main() {
         display,     // Соединение с X11
         root,        // Родительское окно (корневое)
         100, 100,    // Координаты появления окна
-        640, 480,    // Размеры окна
+        windowWidth, windowHeight, // Размеры окна
         1,           // Толщина рамки
         BlackPixel(display, screen), // Цвет рамки
-        WhitePixel(display, screen)  // Цвет фона
+        BlackPixel(display, screen)  // Цвет фона
     );
+    XSelectInput(display, window, ExposureMask | StructureNotifyMask);
 
     // 🔹 Отправляем событие: хотим закрытие окна
     Atom delWindow = XInternAtom(display, "WM_DELETE_WINDOW", False);
@@ -107,28 +442,82 @@ int main() {
     XMapWindow(display, window);
     XFlush(display);  // Обновляем экран
 
+    // 📏 DPI из физического размера экрана
+    int widthMM = DisplayWidthMM(display, screen);
+    app.setDPI(widthMM > 0 ? int(DisplayWidth(display, screen) * 25.4f / widthMM) : 96);
+
+    GC gc = DefaultGC(display, screen);
+    FrameSnapshot initial;
+    captureSnapshot(initial);
+    sceneLoad.poll(); // 🔹 что успело загрузиться, пока создавалось окно
+    renderSnapshot(initial);
+    profiler().nextFrame(); // ⏱️ первый кадр выводит Expose; дальше кадр = от вывода до вывода
 
-    std::thread inputThread(&App::waitForLine, &app);
-    app.setLinuxDisplay(display, window)
-    app.initGraphics();        // ✅ создать контекст рисования один раз
-    // 🔹 Обрабатываем события
-    app.loader("../data/3d/cube.json");
-    while (true) {
-        // 🔁 Обрабатываем события (если есть)
-        while (XPending(display)) {
-            XEvent e;
-            XNextEvent(display, &e);
-            if (e.type == ClientMessage && (Atom)e.xclient.data.l[0] == delWindow)
-                goto cleanup;
+    // 🧵 Есть сценарии или анимации — симуляция на своём потоке будит цикл байтом в pipe (как и загрузка сцены)
+    if (needsSimulation())
+        startSimulation(initial);
+    auto latest = [&]() -> const FrameSnapshot& { return simulation.running() ? simulation.latest() : initial; };
+
+    // 🔹 Обрабатываем события; между ними спим в select() на сокете X-сервера и pipe (симуляция, загрузка)
+    bool running = true;
+    while (running) {
+        if (!XPending(display)) {
+            fd_set fds;
+            FD_ZERO(&fds);
+            int xfd = ConnectionNumber(display);
+            FD_SET(xfd, &fds);
+            if (wakePipe[0] >= 0) FD_SET(wakePipe[0], &fds);
+            if (select(std::max(xfd, wakePipe[0]) + 1, &fds, NULL, NULL, NULL) < 0) continue;
+
+            if (wakePipe[0] >= 0 && FD_ISSET(wakePipe[0], &fds)) {
+                char drain[64];
+                while (read(wakePipe[0], drain, sizeof(drain)) > 0) {}
+                bool fresh = simulation.acquire();
+                bool loaded = sceneLoad.poll() > 0;
+                if ((fresh || loaded) && renderSnapshot(latest())) {
+                    presentFramebuffer(display, window, gc, app.frame, frameDamage.full ? nullptr : &frameDamage.rects);
+                    profiler().nextFrame(); // ⏱️ кадр потока рендера кончается выводом на экран
+                }
+            }
+            continue;
+        }
+
+        XEvent e;
+        XNextEvent(display, &e);
+        switch (e.type) {
+            case Expose:
+                if (e.xexpose.count == 0)
+                    presentFramebuffer(display, window, gc, app.frame);
+                break;
+
+            case ConfigureNotify:
+                if (e.xconfigure.width != windowWidth || e.xconfigure.height != windowHeight) {
+                    windowWidth = e.xconfigure.width;
+                    windowHeight = e.xconfigure.height;
+                    renderSnapshot(latest()); // 🔹 другой размер — трекер сам перерисует кадр целиком
+                    presentFramebuffer(display, window, gc, app.frame);
+                    profiler().nextFrame();
+                }
+                break;
+
+            case ClientMessage:
+                if ((Atom)e.xclient.data.l[0] == delWindow)
+                    running = false;
+                break;
         }
-        app.update();
     }
 
     // 🔹 Закрываем и очищаем ресурсы
-    app.cleanup();             // 🔒 освободить контекст перед выходом
+    simulation.stop();
+    sceneLoad.wait(); // ⚠️ задачи загрузки ещё могут писать в pipe
+    if (wakePipe[0] >= 0) {
+        close(wakePipe[0]);
+        close(wakePipe[1]);
+    }
     XDestroyWindow(display, window);
     XCloseDisplay(display);
 #endif
 
+    finishProfile(profilePath);
     return 0;  // Завершение программы
 }
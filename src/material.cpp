@@ -0,0 +1,142 @@
+// material.cpp
+#include "material.hpp"
+#include "mesh.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+LightType parseLightType(const std::string& name) {
+    if (name == "unlit" || name == "none") return LightType::Unlit;
+    if (name == "emissive" || name == "light") return LightType::Emissive;
+    return LightType::Lit;
+}
+
+LightTargetId LightTargetTable::intern(const std::string& name) {
+    if (name.empty() || name == "none" || name == "all") return LIGHT_TARGET_ALL;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = ids.find(name);
+    if (it != ids.end()) return it->second;
+    if (ids.size() + 1 > 0xFFFF) return LIGHT_TARGET_ALL; // ⚠️ имена кончились — свет для всех
+    LightTargetId id = LightTargetId(ids.size() + 1);
+    ids.emplace(name, id);
+    return id;
+}
+
+size_t LightTargetTable::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return ids.size() + 1;
+}
+
+LightTargetTable& lightTargets() {
+    static LightTargetTable table;
+    return table;
+}
+
+Material makeMaterial(const std::string& lightType, const std::string& lightTarget, float roughness, float metallic) {
+    Material m;
+    m.type = parseLightType(lightType);
+    m.target = lightTargets().intern(lightTarget);
+    m.roughness = std::clamp(roughness, 0.0f, 1.0f);
+    m.metallic = std::clamp(metallic, 0.0f, 1.0f);
+
+    // ✨ Гладкое — узкий яркий блик, шероховатое — широкий тусклый (приближение GGX → Блинн–Фонг)
+    float r = std::max(m.roughness, 0.05f);
+    m.shininess = std::min(1024.0f, 2.0f / (r * r * r * r) - 2.0f);
+    return m;
+}
+
+void buildMeshNormals(Mesh& mesh) {
+    const Mesh& source = mesh; // 🔹 читаем только через const: координаты из кэша не копируются
+    size_t polygons = source.polygonCount();
+    mesh.normalX.resize(polygons);
+    mesh.normalY.resize(polygons);
+    mesh.normalZ.resize(polygons);
+    float* normalX = mesh.normalX.mutableData();
+    float* normalY = mesh.normalY.mutableData();
+    float* normalZ = mesh.normalZ.mutableData();
+    const float* x = source.x.data();
+    const float* y = source.y.data();
+    const float* z = source.z.data();
+
+    // 📐 Нормаль Ньюэлла — устойчива и для невыпуклых, и для почти вырожденных полигонов
+    for (size_t p = 0; p < polygons; ++p) {
+        uint32_t begin = source.polygonPointBegin(p), end = source.polygonPointEnd(p);
+        float nx = 0.0f, ny = 0.0f, nz = 0.0f;
+        for (uint32_t i = begin; end - begin >= 3 && i < end; ++i) {
+            uint32_t j = i + 1 < end ? i + 1 : begin;
+            nx += (y[i] - y[j]) * (z[i] + z[j]);
+            ny += (z[i] - z[j]) * (x[i] + x[j]);
+            nz += (x[i] - x[j]) * (y[i] + y[j]);
+        }
+        float length = std::sqrt(nx * nx + ny * ny + nz * nz);
+        float k = length > 1e-12f ? 1.0f / length : 0.0f; // 0 — линии и точки: освещению нечем
+        normalX[p] = nx * k;
+        normalY[p] = ny * k;
+        normalZ[p] = nz * k;
+    }
+}
+
+// 🔑 Ключ словаря материалов — те же поля, что сравнивает Material::operator==
+static uint32_t floatBits(float value) {
+    value += 0.0f; // 🔹 -0 → +0: они равны, значит и хэш у них один
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+struct MaterialHash {
+    size_t operator()(const Material& m) const {
+        uint64_t head = (uint64_t(m.type) << 16) | m.target;
+        uint64_t tail = (uint64_t(floatBits(m.roughness)) << 32) | floatBits(m.metallic);
+        return std::hash<uint64_t>()(head * 0x9E3779B97F4A7C15ull ^ tail);
+    }
+};
+
+void buildMeshMaterials(Mesh& mesh) {
+    // 🔹 Всё исходное — через const: запись только в новые массивы, отображённые из кэша остаются как есть
+    const Mesh& source = mesh;
+    size_t polygons = source.polygonCount();
+    mesh.materials.clear();
+    mesh.emitters.clear();
+    mesh.polygonMaterial.resize(polygons);
+    uint16_t* polygonMaterial = mesh.polygonMaterial.mutableData();
+
+    // 🔹 Соседние полигоны обычно с одинаковым материалом — сначала сверяем с предыдущим,
+    // остальные ищем в словаре: линейный поиск по материалам на каждый полигон — квадрат
+    std::unordered_map<Material, uint16_t, MaterialHash> indexOf;
+    uint16_t last = 0;
+    size_t overflow = 0;
+    for (size_t p = 0; p < polygons; ++p) {
+        Material m = makeMaterial(p < source.lightType.size() ? source.lightType[p] : std::string(),
+                                  p < source.lightTarget.size() ? source.lightTarget[p] : std::string(),
+                                  source.roughness[p], source.metallic[p]);
+        if (mesh.materials.empty() || !(mesh.materials[last] == m)) {
+            auto it = indexOf.find(m);
+            if (it != indexOf.end()) {
+                last = it->second;
+            } else if (mesh.materials.size() < 0xFFFF) {
+                last = uint16_t(mesh.materials.size());
+                indexOf.emplace(m, last);
+                mesh.materials.push_back(m);
+            } else {
+                ++overflow; // ⚠️ номера кончились — полигон получит материал 0, об этом скажем ниже
+                last = 0;
+            }
+        }
+        polygonMaterial[p] = last;
+
+        if (m.type == LightType::Emissive) {
+            for (uint32_t i = source.polygonPointBegin(p); i < source.polygonPointEnd(p); ++i)
+                if (source.lightIntensity[i] > 0.0f) mesh.emitters.push_back({ i, m.target });
+        }
+    }
+
+    if (overflow > 0)
+        std::cerr << "Model " << source.modelName << " has more than 65535 materials: " << overflow
+                  << " polygon(s) drawn with the first one\n";
+
+    if (!source.hasNormals()) buildMeshNormals(mesh); // 📐 из кэша нормали приходят готовыми
+}
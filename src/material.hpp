@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct Mesh;
+
+// 💡 Как полигон отвечает на свет (поле lightType модели)
+enum class LightType : uint8_t {
+    Lit,      // "normal" и всё незнакомое — освещается: окружение + солнце + точечные источники
+    Unlit,    // "unlit", "none" — свой цвет как есть
+    Emissive, // "emissive", "light" — светится сам; точки с lightIntensity > 0 — точечные источники
+};
+
+LightType parseLightType(const std::string& name);
+
+typedef uint16_t LightTargetId; // 🔹 номер имени lightTarget (общий для всех моделей)
+const LightTargetId LIGHT_TARGET_ALL = 0; // "", "none", "all" — без адресата: свет от всех / для всех
+
+// 🏷️ Имена lightTarget → номера. Один на процесс: источник из одной модели находит поверхности другой.
+// Пополняется при загрузке (с рабочих потоков — под блокировкой), в кадре не используется
+class LightTargetTable {
+public:
+    LightTargetId intern(const std::string& name);
+    size_t size() const;
+
+private:
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, LightTargetId> ids;
+};
+
+LightTargetTable& lightTargets();
+
+// 🎨 Материал полигона: всё, что нужно освещению, — числами
+struct Material {
+    LightType type = LightType::Lit;
+    LightTargetId target = LIGHT_TARGET_ALL;
+    float roughness = 0.5f;
+    float metallic = 0.0f;
+    float shininess = 32.0f; // 🔹 показатель блика Блинна–Фонга — из roughness, считается один раз
+
+    bool operator==(const Material& other) const {
+        return type == other.type && target == other.target && roughness == other.roughness && metallic == other.metallic;
+    }
+};
+
+// 🔆 Точка светящегося полигона, которая сама светит (lightIntensity > 0) — точечный источник
+struct Emitter {
+    uint32_t point;        // индекс точки модели
+    LightTargetId target;  // lightTarget её полигона — кого освещает
+};
+
+Material makeMaterial(const std::string& lightType, const std::string& lightTarget, float roughness, float metallic);
+
+// 🔨 Материалы модели: строки полигонов → Mesh::materials / polygonMaterial, источники — в Mesh::emitters,
+// и нормали, если их ещё нет. Вызывается при загрузке (и из JSON, и из кэша) — дальше рендер строк не трогает
+void buildMeshMaterials(Mesh& mesh);
+
+// 📐 Нормали полигонов по Ньюэллу (Mesh::normalX/Y/Z) — только геометрия, поэтому пишутся в кэш
+void buildMeshNormals(Mesh& mesh);
@@ -0,0 +1,110 @@
+// mesh.cpp
+#include "mesh.hpp"
+
+#include <utility>
+
+void Mesh::reserve(size_t points, size_t lines, size_t polygons) {
+    x.reserve(points);
+    y.reserve(points);
+    z.reserve(points);
+    r.reserve(points);
+    g.reserve(points);
+    b.reserve(points);
+    opacity.reserve(points);
+    lightIntensity.reserve(points);
+
+    lineStart.reserve(lines + 1);
+
+    polygonStart.reserve(polygons + 1);
+    roughness.reserve(polygons);
+    metallic.reserve(polygons);
+    lightTarget.reserve(polygons);
+    lightType.reserve(polygons);
+}
+
+void Mesh::addPoint(const Point3D& p) {
+    x.push_back(p.x);
+    y.push_back(p.y);
+    z.push_back(p.z);
+    r.push_back(p.r);
+    g.push_back(p.g);
+    b.push_back(p.b);
+    opacity.push_back(p.opacity);
+    lightIntensity.push_back(p.lightIntensity);
+}
+
+void Mesh::endLine() {
+    lineStart.push_back(uint32_t(pointCount()));
+}
+
+void Mesh::endPolygon(float polyRoughness, float polyMetallic,
+                      std::string polyLightTarget, std::string polyLightType) {
+    polygonStart.push_back(uint32_t(lineCount()));
+    roughness.push_back(polyRoughness);
+    metallic.push_back(polyMetallic);
+    lightTarget.push_back(std::move(polyLightTarget));
+    lightType.push_back(std::move(polyLightType));
+}
+
+Point3D Mesh::point(size_t i) const {
+    Point3D p;
+    p.x = x[i];
+    p.y = y[i];
+    p.z = z[i];
+    p.r = r[i];
+    p.g = g[i];
+    p.b = b[i];
+    p.opacity = opacity[i];
+    p.lightIntensity = lightIntensity[i];
+    return p;
+}
+
+Mesh toMesh(const Model& model) {
+    Mesh mesh;
+    mesh.modelName = model.modelName;
+    mesh.castShadow = model.castShadow;
+
+    // 🔹 Сначала считаем размеры — потом одна аллокация на массив
+    size_t points = 0, lines = 0;
+    for (const auto& poly : model.polygons) {
+        lines += poly.lines.size();
+        for (const auto& line : poly.lines)
+            points += line.points.size();
+    }
+    mesh.reserve(points, lines, model.polygons.size());
+
+    for (const auto& poly : model.polygons) {
+        for (const auto& line : poly.lines) {
+            for (const auto& p : line.points)
+                mesh.addPoint(p);
+            mesh.endLine();
+        }
+        mesh.endPolygon(poly.roughness, poly.metallic, poly.lightTarget, poly.lightType);
+    }
+    buildMeshBounds(mesh);
+    return mesh;
+}
+
+Model toModel(const Mesh& mesh) {
+    Model model;
+    model.modelName = mesh.modelName;
+    model.castShadow = mesh.castShadow;
+    model.polygons.resize(mesh.polygonCount());
+
+    for (size_t p = 0; p < mesh.polygonCount(); ++p) {
+        Polygon3D& poly = model.polygons[p];
+        poly.roughness = mesh.roughness[p];
+        poly.metallic = mesh.metallic[p];
+        poly.lightTarget = mesh.lightTarget[p];
+        poly.lightType = mesh.lightType[p];
+
+        for (uint32_t l = mesh.polygonLineBegin(p); l < mesh.polygonLineEnd(p); ++l) {
+            Line line;
+            line.points.reserve(mesh.lineEnd(l) - mesh.lineBegin(l));
+            for (uint32_t i = mesh.lineBegin(l); i < mesh.lineEnd(l); ++i)
+                line.points.push_back(mesh.point(i));
+            poly.lines.push_back(std::move(line));
+        }
+    }
+    return model;
+}
@@ -0,0 +1,156 @@
+#pragma once
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bvh.hpp"
+#include "core.hpp"
+#include "material.hpp"
+
+class MappedFile;
+
+// 🧱 Плотный массив модели: либо свой std::vector, либо «чужая» память
+// (например, отображённый файл кэша — см. mesh_cache.hpp). Чтение одинаковое,
+// а при первой записи в чужую память массив сначала копируется к себе.
+// ⚠️ Запись только явная (mutableData, push_back, resize...): operator[] и data() всегда
+// читают, поэтому обращение через неконстантный Mesh не копирует отображённый массив.
+template <typename T>
+class MeshArray {
+public:
+    MeshArray() = default;
+    MeshArray(std::initializer_list<T> values) : owned_(values) { sync(); }
+
+    MeshArray(const MeshArray& other) : owned_(other.owned_), ptr_(other.ptr_), size_(other.size_), borrowed_(other.borrowed_) {
+        if (!borrowed_) sync();
+    }
+    MeshArray(MeshArray&& other) noexcept : owned_(std::move(other.owned_)), ptr_(other.ptr_), size_(other.size_), borrowed_(other.borrowed_) {
+        if (!borrowed_) sync();
+        other.ptr_ = nullptr;
+        other.size_ = 0;
+        other.borrowed_ = false;
+    }
+    MeshArray& operator=(MeshArray other) noexcept {
+        owned_.swap(other.owned_);
+        ptr_ = other.ptr_;
+        size_ = other.size_;
+        borrowed_ = other.borrowed_;
+        if (!borrowed_) sync();
+        return *this;
+    }
+
+    // 🔗 Указать на чужую память (без копирования). Владелец памяти должен жить дольше массива
+    void borrow(const T* data, size_t count) {
+        owned_.clear();
+        owned_.shrink_to_fit();
+        ptr_ = data;
+        size_ = count;
+        borrowed_ = true;
+    }
+    bool borrowed() const { return borrowed_; }
+
+    const T* data() const { return ptr_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const T& operator[](size_t i) const { return ptr_[i]; }
+    const T* begin() const { return ptr_; }
+    const T* end() const { return ptr_ + size_; }
+
+    // ✏️ Запись — только в свою память (чужую сначала копируем)
+    T* mutableData() { own(); return owned_.data(); }
+    void push_back(const T& value) { own(); owned_.push_back(value); sync(); }
+    void reserve(size_t count) { own(); owned_.reserve(count); sync(); }
+    void resize(size_t count) { own(); owned_.resize(count); sync(); }
+    void assign(const T* first, const T* last) { own(); owned_.assign(first, last); sync(); }
+
+private:
+    void sync() { ptr_ = owned_.data(); size_ = owned_.size(); }
+    void own() {
+        if (!borrowed_) return;
+        owned_.assign(ptr_, ptr_ + size_);
+        borrowed_ = false;
+        sync();
+    }
+
+    std::vector<T> owned_;
+    const T* ptr_ = nullptr;
+    size_t size_ = 0;
+    bool borrowed_ = false;
+};
+
+// 📦 Плоская модель (structure-of-arrays): никаких вложенных векторов,
+// координаты лежат подряд — обход кадра идёт по памяти линейно, без прыжков по указателям.
+struct Mesh {
+    std::string modelName;
+    bool castShadow = false;
+
+    // 📍 Координаты точек (в см) — отдельные плотные массивы
+    MeshArray<float> x, y, z;
+
+    // 🎨 Атрибуты точек — отдельно от координат, чтобы не тянуть их в кэш при проекции
+    MeshArray<uint8_t> r, g, b;
+    MeshArray<float> opacity;
+    MeshArray<float> lightIntensity;
+
+    // 📏 Линии: точки линии i — это [lineStart[i], lineStart[i + 1])
+    MeshArray<uint32_t> lineStart{ 0 };
+
+    // 🔷 Полигоны: линии полигона p — это [polygonStart[p], polygonStart[p + 1])
+    MeshArray<uint32_t> polygonStart{ 0 };
+    MeshArray<float> roughness;
+    MeshArray<float> metallic;
+    std::vector<std::string> lightTarget; // строки — по одной на полигон, в кэше не отображаются
+    std::vector<std::string> lightType;
+
+    // 💡 Для освещения (buildMeshMaterials при загрузке): строки выше — уже числами. Номера lightTarget
+    // общие на процесс, поэтому материалы в кэш не пишутся; нормали — пишутся (buildMeshNormals)
+    std::vector<Material> materials;            // уникальные материалы модели
+    MeshArray<uint16_t> polygonMaterial;        // индекс в materials по полигону
+    MeshArray<float> normalX, normalY, normalZ; // единичная нормаль полигона; 0 — нечем освещать
+    std::vector<Emitter> emitters;              // точечные источники света модели
+
+    // 📦 Границы для отсечения по пирамиде видимости (buildMeshBounds, кэшируются вместе с моделью)
+    AABB bounds;                      // вся модель
+    MeshArray<AABB> polygonBounds;    // по одной коробке на полигон
+    MeshArray<BvhNode> bvhNodes;      // BVH по полигонам
+    MeshArray<uint32_t> bvhOrder;     // индексы полигонов в порядке листьев BVH
+
+    // 🗺️ Если массивы смотрят в файл кэша — держим отображение живым, пока жив Mesh (и его копии)
+    std::shared_ptr<const MappedFile> mapping;
+
+    size_t pointCount() const { return x.size(); }
+    size_t lineCount() const { return lineStart.size() - 1; }
+    size_t polygonCount() const { return polygonStart.size() - 1; }
+    // 🌳 BVH есть и полигоны покрывают все линии и точки — тогда отсечение по нему ничего не теряет
+    bool hasBvh() const {
+        return !bvhNodes.empty() && polygonBounds.size() == polygonCount() &&
+               polygonStart[polygonCount()] == lineCount() && lineStart[lineCount()] == pointCount();
+    }
+
+    bool hasMaterials() const { return polygonMaterial.size() == polygonCount() && !materials.empty(); }
+    bool hasNormals() const {
+        return normalX.size() == polygonCount() && normalY.size() == polygonCount() && normalZ.size() == polygonCount();
+    }
+
+    // 🔹 Диапазоны индексов
+    uint32_t lineBegin(size_t line) const { return lineStart[line]; }
+    uint32_t lineEnd(size_t line) const { return lineStart[line + 1]; }
+    uint32_t polygonLineBegin(size_t poly) const { return polygonStart[poly]; }
+    uint32_t polygonLineEnd(size_t poly) const { return polygonStart[poly + 1]; }
+    uint32_t polygonPointBegin(size_t poly) const { return lineStart[polygonStart[poly]]; }
+    uint32_t polygonPointEnd(size_t poly) const { return lineStart[polygonStart[poly + 1]]; }
+
+    // ───── Построение: addPoint... endLine() ... endPolygon(...) ─────
+    void reserve(size_t points, size_t lines = 0, size_t polygons = 0);
+    void addPoint(const Point3D& p);
+    void endLine();      // закрывает линию из точек, добавленных после прошлой endLine()
+    void endPolygon(float polyRoughness, float polyMetallic,
+                    std::string polyLightTarget, std::string polyLightType); // закрывает полигон из линий после прошлого endPolygon()
+
+    Point3D point(size_t i) const; // 🔹 Собрать точку обратно в старую структуру
+};
+
+// 🔁 Совместимость со старым вложенным представлением Model → Polygon3D → Line → Point3D
+Mesh toMesh(const Model& model);
+Model toModel(const Mesh& mesh);
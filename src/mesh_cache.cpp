@@ -0,0 +1,313 @@
+// mesh_cache.cpp
+#include "mesh_cache.hpp"
+#include "mapped_file.hpp"
+#include "mesh.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static const char MESH_CACHE_MAGIC[8] = { '3', 'D', 'S', 'M', 'E', 'S', 'H', '\0' };
+static const uint32_t MESH_CACHE_BYTE_ORDER = 0x01020304u;
+static const uint64_t MESH_CACHE_ALIGN = 64;
+
+// 🔹 Номера секций — часть формата, менять только вместе с MESH_CACHE_VERSION
+enum MeshCacheSectionId : uint32_t {
+    SECTION_X = 1,
+    SECTION_Y,
+    SECTION_Z,
+    SECTION_R,
+    SECTION_G,
+    SECTION_B,
+    SECTION_OPACITY,
+    SECTION_LIGHT_INTENSITY,
+    SECTION_LINE_START,
+    SECTION_POLYGON_START,
+    SECTION_ROUGHNESS,
+    SECTION_METALLIC,
+    SECTION_STRINGS, // имя модели + lightTarget/lightType полигонов: [uint32 длина][байты]...
+    SECTION_POLYGON_BOUNDS,
+    SECTION_BVH_NODES,
+    SECTION_BVH_ORDER,
+    SECTION_NORMAL_X, // 📐 пустые, если модель записана без buildMeshNormals
+    SECTION_NORMAL_Y,
+    SECTION_NORMAL_Z,
+};
+
+// 🧱 Все плотные массивы Mesh с их номерами — одно место для записи и чтения
+template <typename MeshT, typename Fn>
+static void forEachArray(MeshT& mesh, Fn&& fn) {
+    fn(SECTION_X, mesh.x);
+    fn(SECTION_Y, mesh.y);
+    fn(SECTION_Z, mesh.z);
+    fn(SECTION_R, mesh.r);
+    fn(SECTION_G, mesh.g);
+    fn(SECTION_B, mesh.b);
+    fn(SECTION_OPACITY, mesh.opacity);
+    fn(SECTION_LIGHT_INTENSITY, mesh.lightIntensity);
+    fn(SECTION_LINE_START, mesh.lineStart);
+    fn(SECTION_POLYGON_START, mesh.polygonStart);
+    fn(SECTION_ROUGHNESS, mesh.roughness);
+    fn(SECTION_METALLIC, mesh.metallic);
+    fn(SECTION_POLYGON_BOUNDS, mesh.polygonBounds);
+    fn(SECTION_BVH_NODES, mesh.bvhNodes);
+    fn(SECTION_BVH_ORDER, mesh.bvhOrder);
+    fn(SECTION_NORMAL_X, mesh.normalX);
+    fn(SECTION_NORMAL_Y, mesh.normalY);
+    fn(SECTION_NORMAL_Z, mesh.normalZ);
+}
+
+// ───── Отпечаток исходника ─────
+
+struct SourceStamp {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint64_t hash = 0;
+};
+
+static uint64_t fnv1a(const char* data, size_t size, uint64_t hash = 1469598103934665603ull) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= uint8_t(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// 🔹 Хэш только по началу и концу файла: ловит подмену с тем же mtime,
+// но не заставляет перечитывать сотни мегабайт при каждом запуске
+static bool stampSource(const std::string& sourcePath, SourceStamp& stamp) {
+    std::error_code ec;
+    stamp.size = fs::file_size(sourcePath, ec);
+    if (ec) return false;
+    stamp.mtime = int64_t(fs::last_write_time(sourcePath, ec).time_since_epoch().count());
+    if (ec) return false;
+
+    const size_t sample = 64 * 1024;
+    std::ifstream file(sourcePath, std::ios::binary);
+    if (!file) return false;
+
+    std::vector<char> buffer(size_t(std::min<uint64_t>(stamp.size, sample)));
+    file.read(buffer.data(), buffer.size());
+    uint64_t hash = fnv1a(buffer.data(), size_t(file.gcount()));
+
+    if (stamp.size > sample) {
+        file.clear();
+        file.seekg(std::streamoff(stamp.size - std::min<uint64_t>(stamp.size - sample, sample)));
+        file.read(buffer.data(), buffer.size());
+        hash = fnv1a(buffer.data(), size_t(file.gcount()), hash);
+    }
+    stamp.hash = hash;
+    return true;
+}
+
+std::string meshCachePath(const std::string& sourcePath) {
+    return sourcePath + ".mesh";
+}
+
+bool isMeshCachePath(const std::string& path) {
+    return path.size() >= 5 && path.compare(path.size() - 5, 5, ".mesh") == 0;
+}
+
+// ───── Запись ─────
+
+static void appendString(std::vector<char>& out, const std::string& s) {
+    uint32_t length = uint32_t(s.size());
+    out.insert(out.end(), reinterpret_cast<const char*>(&length), reinterpret_cast<const char*>(&length) + 4);
+    out.insert(out.end(), s.begin(), s.end());
+}
+
+bool writeMeshCache(const std::string& cachePath, const Mesh& mesh, const std::string& sourcePath) {
+    SourceStamp stamp;
+    if (!sourcePath.empty() && !stampSource(sourcePath, stamp)) return false;
+
+    // 📋 Собираем список секций: указатель + размер
+    struct Blob { uint32_t id; const void* data; uint64_t bytes; };
+    std::vector<Blob> blobs;
+    forEachArray(mesh, [&](uint32_t id, const auto& array) {
+        blobs.push_back({ id, array.data(), uint64_t(array.size()) * sizeof(array[0]) });
+    });
+
+    std::vector<char> strings;
+    appendString(strings, mesh.modelName);
+    for (size_t p = 0; p < mesh.polygonCount(); ++p) {
+        appendString(strings, mesh.lightTarget[p]);
+        appendString(strings, mesh.lightType[p]);
+    }
+    blobs.push_back({ SECTION_STRINGS, strings.data(), strings.size() });
+
+    MeshCacheHeader header = {};
+    std::memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(header.magic));
+    header.version = MESH_CACHE_VERSION;
+    header.byteOrder = MESH_CACHE_BYTE_ORDER;
+    header.sourceSize = stamp.size;
+    header.sourceMtime = stamp.mtime;
+    header.sourceHash = stamp.hash;
+    header.pointCount = mesh.pointCount();
+    header.lineCount = mesh.lineCount();
+    header.polygonCount = mesh.polygonCount();
+    header.castShadow = mesh.castShadow ? 1 : 0;
+    header.sectionCount = uint32_t(blobs.size());
+    std::memcpy(header.boundsMin, mesh.bounds.min, sizeof(header.boundsMin));
+    std::memcpy(header.boundsMax, mesh.bounds.max, sizeof(header.boundsMax));
+
+    // 📐 Раскладка: заголовок, таблица, затем массивы с шагом выравнивания
+    std::vector<MeshCacheSection> sections(blobs.size());
+    uint64_t offset = sizeof(MeshCacheHeader) + sizeof(MeshCacheSection) * sections.size();
+    for (size_t i = 0; i < blobs.size(); ++i) {
+        offset = (offset + MESH_CACHE_ALIGN - 1) / MESH_CACHE_ALIGN * MESH_CACHE_ALIGN;
+        sections[i] = { blobs[i].id, 0, offset, blobs[i].bytes };
+        offset += blobs[i].bytes;
+    }
+
+    std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(sections.data()), sizeof(MeshCacheSection) * sections.size());
+
+        static const char zeros[MESH_CACHE_ALIGN] = {};
+        uint64_t written = sizeof(MeshCacheHeader) + sizeof(MeshCacheSection) * sections.size();
+        for (size_t i = 0; i < blobs.size(); ++i) {
+            file.write(zeros, std::streamsize(sections[i].offset - written));
+            file.write(static_cast<const char*>(blobs[i].data), std::streamsize(blobs[i].bytes));
+            written = sections[i].offset + blobs[i].bytes;
+        }
+        if (!file) {
+            file.close();
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tempPath, cachePath, ec);
+    if (ec) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+// ───── Чтение ─────
+
+// 📏 Смещения начинаются с 0, не убывают и кончаются ровно на total — иначе диапазоны линий
+// и полигонов выйдут за массивы, а растеризатор читает их без проверок
+static bool validOffsets(const MeshArray<uint32_t>& start, size_t total) {
+    if (start.size() == 0 || start[0] != 0 || start[start.size() - 1] != total) return false;
+    for (size_t i = 1; i < start.size(); ++i)
+        if (start[i] < start[i - 1]) return false;
+    return true;
+}
+
+static bool readString(const char*& cursor, const char* end, std::string& out) {
+    uint32_t length;
+    if (end - cursor < 4) return false;
+    std::memcpy(&length, cursor, 4);
+    cursor += 4;
+    if (uint64_t(end - cursor) < length) return false;
+    out.assign(cursor, length);
+    cursor += length;
+    return true;
+}
+
+bool readMeshCache(const std::string& cachePath, Mesh& mesh, const std::string& sourcePath) {
+    auto mapping = std::make_shared<MappedFile>();
+    if (!mapping->open(cachePath)) return false;
+
+    const unsigned char* base = mapping->data();
+    size_t fileSize = mapping->size();
+    if (fileSize < sizeof(MeshCacheHeader)) return false;
+
+    MeshCacheHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, MESH_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != MESH_CACHE_VERSION ||
+        header.byteOrder != MESH_CACHE_BYTE_ORDER)
+        return false;
+
+    // 🕒 Исходник менялся — кэш устарел
+    if (!sourcePath.empty()) {
+        SourceStamp stamp;
+        if (!stampSource(sourcePath, stamp) ||
+            stamp.size != header.sourceSize || stamp.mtime != header.sourceMtime || stamp.hash != header.sourceHash)
+            return false;
+    }
+
+    uint64_t tableEnd = sizeof(MeshCacheHeader) + uint64_t(header.sectionCount) * sizeof(MeshCacheSection);
+    if (tableEnd > fileSize) return false;
+    const MeshCacheSection* sections = reinterpret_cast<const MeshCacheSection*>(base + sizeof(MeshCacheHeader));
+
+    auto findSection = [&](uint32_t id) -> const MeshCacheSection* {
+        for (uint32_t i = 0; i < header.sectionCount; ++i)
+            if (sections[i].id == id && sections[i].offset % MESH_CACHE_ALIGN == 0 &&
+                sections[i].offset <= fileSize && sections[i].bytes <= fileSize - sections[i].offset)
+                return &sections[i];
+        return nullptr;
+    };
+
+    Mesh loaded;
+    bool ok = true;
+    forEachArray(loaded, [&](uint32_t id, auto& array) {
+        using T = std::decay_t<decltype(array[0])>;
+        const MeshCacheSection* section = findSection(id);
+        if (!section || section->bytes % sizeof(T) != 0) {
+            ok = false;
+            return;
+        }
+        // 🔗 Без копирования: массив смотрит прямо в отображённый файл
+        array.borrow(reinterpret_cast<const T*>(base + section->offset), size_t(section->bytes / sizeof(T)));
+    });
+    if (!ok) return false;
+
+    // ⚠️ Размеры секций должны сходиться со счётчиками — иначе кэш битый
+    size_t points = size_t(header.pointCount);
+    if (loaded.x.size() != points || loaded.y.size() != points || loaded.z.size() != points ||
+        loaded.r.size() != points || loaded.g.size() != points || loaded.b.size() != points ||
+        loaded.opacity.size() != points || loaded.lightIntensity.size() != points ||
+        loaded.lineStart.size() != header.lineCount + 1 || loaded.polygonStart.size() != header.polygonCount + 1 ||
+        loaded.roughness.size() != header.polygonCount || loaded.metallic.size() != header.polygonCount ||
+        !validOffsets(loaded.lineStart, points) || !validOffsets(loaded.polygonStart, size_t(header.lineCount)))
+        return false;
+
+    // 📐 Нормали: все три по полигону или ни одной (тогда их посчитает buildMeshMaterials)
+    size_t normals = loaded.normalX.size();
+    if ((normals != 0 && normals != header.polygonCount) || loaded.normalY.size() != normals || loaded.normalZ.size() != normals)
+        return false;
+
+    // 🌳 BVH: либо пустой (модель без полигонов), либо все индексы в своих пределах
+    if (loaded.polygonBounds.size() != header.polygonCount || loaded.bvhOrder.size() != header.polygonCount)
+        return false;
+    for (uint32_t index : loaded.bvhOrder)
+        if (index >= header.polygonCount) return false;
+    if (!validateBvh(loaded.bvhNodes.data(), loaded.bvhNodes.size(), size_t(header.polygonCount)))
+        return false;
+
+    const MeshCacheSection* strings = findSection(SECTION_STRINGS);
+    if (!strings) return false;
+    const char* cursor = reinterpret_cast<const char*>(base + strings->offset);
+    const char* end = cursor + strings->bytes;
+    if (!readString(cursor, end, loaded.modelName)) return false;
+    loaded.lightTarget.resize(size_t(header.polygonCount));
+    loaded.lightType.resize(size_t(header.polygonCount));
+    for (size_t p = 0; p < header.polygonCount; ++p) {
+        if (!readString(cursor, end, loaded.lightTarget[p]) || !readString(cursor, end, loaded.lightType[p]))
+            return false;
+    }
+
+    loaded.castShadow = header.castShadow != 0;
+    std::memcpy(loaded.bounds.min, header.boundsMin, sizeof(header.boundsMin));
+    std::memcpy(loaded.bounds.max, header.boundsMax, sizeof(header.boundsMax));
+    loaded.mapping = std::move(mapping);
+    mesh = std::move(loaded);
+    return true;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+struct Mesh;
+
+// 💾 Бинарный кэш модели: заголовок + таблица секций + массивы, выровненные по 64 байта.
+// Лежит рядом с JSON (cube.json → cube.json.mesh) и отображается в память без копирования.
+const uint32_t MESH_CACHE_VERSION = 3; // 2: + границы модели, коробки полигонов и BVH; 3: + нормали полигонов
+
+struct MeshCacheHeader {
+    char magic[8];          // "3DSMESH\0"
+    uint32_t version;       // MESH_CACHE_VERSION — другой номер = кэш устарел
+    uint32_t byteOrder;     // 0x01020304 в порядке байт машины, которая писала файл
+    uint64_t sourceSize;    // 📏 размер исходного JSON
+    int64_t sourceMtime;    // 🕒 время изменения исходного JSON
+    uint64_t sourceHash;    // #️⃣ FNV-1a по первым и последним 64 КБ исходника
+    uint64_t pointCount;
+    uint64_t lineCount;
+    uint64_t polygonCount;
+    uint32_t castShadow;
+    uint32_t sectionCount;
+    float boundsMin[3];     // 📦 коробка всей модели
+    float boundsMax[3];
+};
+
+struct MeshCacheSection {
+    uint32_t id;     // какой массив Mesh (см. mesh_cache.cpp)
+    uint32_t reserved;
+    uint64_t offset; // от начала файла, кратно 64
+    uint64_t bytes;
+};
+
+std::string meshCachePath(const std::string& sourcePath); // 📄 путь кэша рядом с исходником
+bool isMeshCachePath(const std::string& path);             // 🔹 файл уже сам является кэшем (*.mesh)
+
+// ✍️ Записать кэш (через временный файл + rename, чтобы не оставить битый кэш)
+bool writeMeshCache(const std::string& cachePath, const Mesh& mesh, const std::string& sourcePath);
+
+// 🗺️ Отобразить кэш в память и направить массивы mesh в него.
+// sourcePath не пустой — кэш принимается, только если совпадают размер, mtime и хэш исходника.
+bool readMeshCache(const std::string& cachePath, Mesh& mesh, const std::string& sourcePath = "");
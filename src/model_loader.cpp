@@ -0,0 +1,337 @@
+// model_loader.cpp
+#include "model_loader.hpp"
+#include "mapped_file.hpp"
+#include "mesh.hpp"
+#include "json.hpp"
+
+#include <cmath>
+#include <streambuf>
+#include <istream>
+#include <vector>
+
+using json = nlohmann::json;
+
+// 📜 streambuf поверх памяти (отображённого файла): парсер читает без копий,
+// а смещение текущего байта — это просто gptr() - eback()
+class MemoryStreambuf : public std::streambuf {
+public:
+    MemoryStreambuf(const char* data, size_t size) {
+        char* begin = const_cast<char*>(data); // ⚠️ только для чтения — streambuf просто не умеет const
+        setg(begin, begin, begin + size);
+    }
+    size_t offset() const { return size_t(gptr() - eback()); }
+};
+
+// 🧩 SAX-обработчик схемы cube.json:
+// { modelName, castShadow, polygons: [ { roughness, metallic, lightTarget, lightType,
+//   lines: [ { points: [ { x, y, z, r, g, b, opacity, lightIntensity } ] } ] } ] }
+// Неизвестные ключи пропускаются целиком, недостающие — ошибка с номером байта.
+class ModelSaxHandler {
+public:
+    ModelSaxHandler(Mesh& mesh, const MemoryStreambuf& input, ModelParseError& error)
+        : mesh(mesh), input(input), error(error) {}
+
+    // ───── Интерфейс SAX (nlohmann::json::sax_parse) ─────
+
+    bool null() { return scalar(Value::Null); }
+    bool boolean(bool val) { boolValue = val; return scalar(Value::Bool); }
+    bool number_integer(json::number_integer_t val) { numberValue = double(val); return scalar(Value::Integer); }
+    bool number_unsigned(json::number_unsigned_t val) { numberValue = double(val); return scalar(Value::Integer); }
+    bool number_float(json::number_float_t val, const json::string_t&) { numberValue = val; return scalar(Value::Float); }
+    bool string(json::string_t& val) { stringValue = &val; return scalar(Value::String); }
+    bool binary(json::binary_t&) { return fail("unexpected binary value"); }
+
+    bool key(json::string_t& val) {
+        if (scope() == Scope::Skip) return true;
+        field = resolveKey(scope(), val);
+        return true;
+    }
+
+    bool start_object(std::size_t) {
+        if (stack.empty()) return push(Scope::Root);
+
+        switch (scope()) {
+            case Scope::Skip:     ++skipDepth; return true;
+            case Scope::Polygons: return beginPolygon();
+            case Scope::Lines:    return push(Scope::Line);
+            case Scope::Points:   return beginPoint();
+            default:
+                if (field == Field::Unknown) return beginSkip();
+                return fail("expected " + std::string(fieldName(field)) + " to be an array, got an object");
+        }
+    }
+
+    bool end_object() {
+        switch (scope()) {
+            case Scope::Skip:    return endSkip();
+            case Scope::Point:   return endPoint();
+            case Scope::Line:    return endLine();
+            case Scope::Polygon: return endPolygon();
+            case Scope::Root:    return endRoot();
+            default:             return fail("unexpected end of object");
+        }
+    }
+
+    bool start_array(std::size_t) {
+        if (stack.empty()) return fail("expected a model object at top level");
+
+        Scope current = scope();
+        if (current == Scope::Skip) { ++skipDepth; return true; }
+
+        if (current == Scope::Root && field == Field::Polygons)   return push(Scope::Polygons, Field::Polygons);
+        if (current == Scope::Polygon && field == Field::Lines)   return push(Scope::Lines, Field::Lines);
+        if (current == Scope::Line && field == Field::Points)     return push(Scope::Points, Field::Points);
+        if (isObjectScope(current) && field == Field::Unknown)    return beginSkip();
+
+        return fail("unexpected array" + (isObjectScope(current) ? " in '" + std::string(fieldName(field)) + "'" : std::string()));
+    }
+
+    bool end_array() {
+        if (scope() == Scope::Skip) return endSkip();
+        stack.pop_back();
+        return true;
+    }
+
+    bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& ex) {
+        error.byteOffset = position;
+        error.message = ex.what();
+        return false;
+    }
+
+private:
+    enum class Scope { Root, Polygons, Polygon, Lines, Line, Points, Point, Skip };
+    enum class Value { Null, Bool, Integer, Float, String };
+
+    // 🔹 Поля схемы; номер = бит в маске «уже встречено»
+    enum class Field {
+        ModelName, CastShadow, Polygons,
+        Roughness, Metallic, LightTarget, LightType, Lines,
+        Points,
+        X, Y, Z, R, G, B, Opacity, LightIntensity,
+        Unknown
+    };
+
+    static uint32_t bit(Field f) { return 1u << uint32_t(f); }
+
+    static const char* fieldName(Field f) {
+        static const char* names[] = {
+            "modelName", "castShadow", "polygons",
+            "roughness", "metallic", "lightTarget", "lightType", "lines",
+            "points",
+            "x", "y", "z", "r", "g", "b", "opacity", "lightIntensity",
+            "?"
+        };
+        return names[int(f)];
+    }
+
+    static bool isObjectScope(Scope s) {
+        return s == Scope::Root || s == Scope::Polygon || s == Scope::Line || s == Scope::Point;
+    }
+
+    // 🔑 Ключ → поле с учётом того, в каком объекте мы находимся
+    static Field resolveKey(Scope s, const std::string& k) {
+        auto pick = [&](Field first, Field last) {
+            for (int f = int(first); f <= int(last); ++f)
+                if (k == fieldName(Field(f))) return Field(f);
+            return Field::Unknown;
+        };
+        switch (s) {
+            case Scope::Root:    return pick(Field::ModelName, Field::Polygons);
+            case Scope::Polygon: return pick(Field::Roughness, Field::Lines);
+            case Scope::Line:    return pick(Field::Points, Field::Points);
+            case Scope::Point:   return pick(Field::X, Field::LightIntensity);
+            default:             return Field::Unknown;
+        }
+    }
+
+    Scope scope() const { return stack.back().scope; }
+
+    bool push(Scope s, Field owner = Field::Unknown) {
+        // 🔹 Массив-владелец отмечается как встреченный у родителя
+        if (owner != Field::Unknown) stack.back().seen |= bit(owner);
+        stack.push_back({ s, 0 });
+        field = Field::Unknown;
+        return true;
+    }
+
+    bool fail(const std::string& message) {
+        error.byteOffset = input.offset();
+        error.message = message;
+        return false;
+    }
+
+    bool requireAll(uint32_t required, const char* what) {
+        uint32_t missing = required & ~stack.back().seen;
+        if (!missing) return true;
+        for (int f = 0; f < int(Field::Unknown); ++f)
+            if (missing & bit(Field(f)))
+                return fail(std::string(what) + " is missing '" + fieldName(Field(f)) + "'");
+        return false;
+    }
+
+    // ───── Пропуск неизвестных значений целиком ─────
+
+    bool beginSkip() {
+        stack.push_back({ Scope::Skip, 0 });
+        skipDepth = 1;
+        return true;
+    }
+
+    bool endSkip() {
+        if (--skipDepth == 0) stack.pop_back();
+        return true;
+    }
+
+    // ───── Объекты схемы ─────
+
+    bool beginPolygon() {
+        roughness = metallic = 0.0f;
+        lightTarget.clear();
+        lightType.clear();
+        return push(Scope::Polygon);
+    }
+
+    bool beginPoint() {
+        point = Point3D{};
+        return push(Scope::Point);
+    }
+
+    bool endPoint() {
+        const uint32_t required = bit(Field::X) | bit(Field::Y) | bit(Field::Z) | bit(Field::R) | bit(Field::G) |
+                                  bit(Field::B) | bit(Field::Opacity) | bit(Field::LightIntensity);
+        if (!requireAll(required, "point")) return false;
+        mesh.addPoint(point); // 📍 точка сразу уходит в плоские массивы
+        stack.pop_back();
+        return true;
+    }
+
+    bool endLine() {
+        if (!requireAll(bit(Field::Points), "line")) return false;
+        mesh.endLine();
+        stack.pop_back();
+        return true;
+    }
+
+    bool endPolygon() {
+        const uint32_t required = bit(Field::Roughness) | bit(Field::Metallic) | bit(Field::LightTarget) |
+                                  bit(Field::LightType) | bit(Field::Lines);
+        if (!requireAll(required, "polygon")) return false;
+        mesh.endPolygon(roughness, metallic, std::move(lightTarget), std::move(lightType));
+        lightTarget = std::string();
+        lightType = std::string();
+        stack.pop_back();
+        return true;
+    }
+
+    bool endRoot() {
+        if (!requireAll(bit(Field::ModelName) | bit(Field::CastShadow) | bit(Field::Polygons), "model")) return false;
+        stack.pop_back();
+        return true;
+    }
+
+    // ───── Скалярные значения ─────
+
+    bool scalar(Value type) {
+        if (stack.empty()) return fail("expected a model object at top level");
+        Scope current = scope();
+        if (current == Scope::Skip) return true;
+        if (!isObjectScope(current)) return fail("expected an object");
+        if (field == Field::Unknown) return true; // неизвестный ключ — просто пропускаем значение
+
+        stack.back().seen |= bit(field);
+        bool isNumber = type == Value::Integer || type == Value::Float;
+
+        switch (field) {
+            case Field::ModelName:
+                if (type != Value::String) return typeError("a string");
+                mesh.modelName = std::move(*stringValue);
+                return true;
+            case Field::CastShadow:
+                if (type != Value::Bool) return typeError("a boolean");
+                mesh.castShadow = boolValue;
+                return true;
+            case Field::LightTarget:
+            case Field::LightType:
+                if (type != Value::String) return typeError("a string");
+                (field == Field::LightTarget ? lightTarget : lightType) = std::move(*stringValue);
+                return true;
+            case Field::R:
+            case Field::G:
+            case Field::B: {
+                if (!isNumber || numberValue < 0.0 || numberValue > 255.0 || std::floor(numberValue) != numberValue)
+                    return typeError("an integer in 0..255");
+                uint8_t v = uint8_t(numberValue);
+                (field == Field::R ? point.r : field == Field::G ? point.g : point.b) = v;
+                return true;
+            }
+            case Field::Polygons:
+            case Field::Lines:
+            case Field::Points:
+                return typeError("an array");
+            default:
+                break;
+        }
+
+        // 🔢 Остальные поля — числа с плавающей точкой
+        if (!isNumber) return typeError("a number");
+        float v = float(numberValue);
+        switch (field) {
+            case Field::Roughness:      roughness = v; break;
+            case Field::Metallic:       metallic = v; break;
+            case Field::X:              point.x = v; break;
+            case Field::Y:              point.y = v; break;
+            case Field::Z:              point.z = v; break;
+            case Field::Opacity:        point.opacity = v; break;
+            case Field::LightIntensity: point.lightIntensity = v; break;
+            default: break;
+        }
+        return true;
+    }
+
+    bool typeError(const char* expected) {
+        return fail("'" + std::string(fieldName(field)) + "' must be " + expected);
+    }
+
+    struct Frame {
+        Scope scope;
+        uint32_t seen; // маска встреченных полей объекта
+    };
+
+    Mesh& mesh;
+    const MemoryStreambuf& input;
+    ModelParseError& error;
+
+    std::vector<Frame> stack;
+    int skipDepth = 0;
+    Field field = Field::Unknown;
+
+    // последнее скалярное значение
+    bool boolValue = false;
+    double numberValue = 0.0;
+    json::string_t* stringValue = nullptr;
+
+    // собираемые сейчас точка и полигон
+    Point3D point{};
+    float roughness = 0.0f, metallic = 0.0f;
+    std::string lightTarget, lightType;
+};
+
+bool parseModelJson(const std::string& path, Mesh& mesh, ModelParseError& error) {
+    MappedFile file;
+    if (!file.open(path)) {
+        error.byteOffset = 0;
+        error.message = "failed to open file";
+        return false;
+    }
+
+    MemoryStreambuf buffer(reinterpret_cast<const char*>(file.data()), file.size());
+    std::istream stream(&buffer);
+
+    Mesh parsed;
+    ModelSaxHandler handler(parsed, buffer, error);
+    if (!json::sax_parse(stream, &handler))
+        return false;
+
+    mesh = std::move(parsed);
+    return true;
+}
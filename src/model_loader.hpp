@@ -0,0 +1,14 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+struct Mesh;
+
+// 🧩 Потоковый (SAX) разбор JSON-модели в формате cube.json прямо в Mesh.
+// Дерево документа не строится: точки пишутся в массивы по мере чтения токенов.
+struct ModelParseError {
+    size_t byteOffset = 0; // 📍 примерное место ошибки в файле
+    std::string message;
+};
+
+bool parseModelJson(const std::string& path, Mesh& mesh, ModelParseError& error);
@@ -0,0 +1,130 @@
+// profiler.cpp
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+
+static const char* STAGE_NAMES[size_t(Stage::Count)] = {
+    "Frame", "Script", "Animate", "Cull", "Project", "Shade", "Shadow", "Raster", "Sort", "Tile", "Present",
+};
+
+const char* stageName(Stage stage) {
+    return stage < Stage::Count ? STAGE_NAMES[size_t(stage)] : "?";
+}
+
+Profiler::Profiler() : epoch(std::chrono::steady_clock::now()) {}
+
+Profiler& profiler() {
+    static Profiler instance;
+    return instance;
+}
+
+// 🧵 Буфер потока создаётся при первом событии и живёт до конца программы (владеет профайлер)
+Profiler::Ring& Profiler::threadRing() {
+    thread_local Ring* ring = nullptr;
+    if (!ring) {
+        auto owned = std::make_unique<Ring>();
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        owned->thread = uint32_t(rings.size());
+        ring = owned.get();
+        rings.push_back(std::move(owned));
+    }
+    return *ring;
+}
+
+void Profiler::record(Stage stage, uint64_t startNs, uint64_t durationNs) {
+    Ring& ring = threadRing();
+
+    // 🔹 Один писатель на буфер: пишем ячейку, потом публикуем head (release) — читатель видит готовое событие
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    ring.events[head % RING_CAPACITY] = { startNs, durationNs, frame.load(std::memory_order_relaxed), stage };
+    ring.head.store(head + 1, std::memory_order_release);
+
+    frameTotals[size_t(stage)].fetch_add(durationNs, std::memory_order_relaxed);
+}
+
+void Profiler::nextFrame() {
+    if (!isEnabled()) {
+        frameStart = 0;
+        return;
+    }
+
+    uint64_t t = now();
+    if (frameStart != 0) {
+        record(Stage::Frame, frameStart, t - frameStart);
+
+        // 📊 Итоги кадра → окно p50/p99
+        std::lock_guard<std::mutex> lock(statsMutex);
+        for (size_t s = 0; s < size_t(Stage::Count); ++s)
+            window[s][windowPos] = float(double(frameTotals[s].exchange(0, std::memory_order_relaxed)) / 1e6);
+        windowPos = (windowPos + 1) % STATS_WINDOW;
+        windowCount = std::min(windowCount + 1, STATS_WINDOW);
+    } else {
+        for (auto& total : frameTotals) total.store(0, std::memory_order_relaxed);
+    }
+
+    frameStart = t;
+    frame.fetch_add(1, std::memory_order_relaxed);
+}
+
+StageStats Profiler::stats(Stage stage) const {
+    std::vector<float> samples;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        samples.assign(window[size_t(stage)].begin(), window[size_t(stage)].begin() + windowCount);
+    }
+
+    StageStats result;
+    result.samples = samples.size();
+    if (samples.empty()) return result;
+
+    std::sort(samples.begin(), samples.end());
+    auto at = [&](double q) { return double(samples[size_t(std::ceil(q * double(samples.size() - 1)))]); };
+    result.p50Ms = at(0.50);
+    result.p99Ms = at(0.99);
+    result.maxMs = samples.back();
+    return result;
+}
+
+std::string Profiler::statsReport() const {
+    std::ostringstream out;
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-8s %10s %10s %10s\n", "stage", "p50 ms", "p99 ms", "max ms");
+    out << line;
+    for (size_t s = 0; s < size_t(Stage::Count); ++s) {
+        StageStats st = stats(Stage(s));
+        if (st.samples == 0) continue;
+        std::snprintf(line, sizeof(line), "%-8s %10.3f %10.3f %10.3f\n", stageName(Stage(s)), st.p50Ms, st.p99Ms, st.maxMs);
+        out << line;
+    }
+    return out.str();
+}
+
+bool Profiler::exportChromeTrace(const std::string& path) const {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    for (const auto& ring : rings) {
+        std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s %u\"}}",
+                     first ? "" : ",\n", ring->thread, ring->thread == 0 ? "main" : "thread", ring->thread);
+        first = false;
+
+        // 🔹 Читаем только опубликованное; если буфер переполнялся — последние RING_CAPACITY событий
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t begin = head > RING_CAPACITY ? head - RING_CAPACITY : 0;
+        for (uint64_t i = begin; i < head; ++i) {
+            const ProfileEvent& e = ring->events[i % RING_CAPACITY];
+            std::fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"frame\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"frame\":%u}}",
+                         stageName(e.stage), double(e.startNs) / 1000.0, double(e.durationNs) / 1000.0, ring->thread, e.frame);
+        }
+    }
+
+    std::fprintf(file, "\n]}\n");
+    return std::fclose(file) == 0;
+}
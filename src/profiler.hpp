@@ -0,0 +1,123 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ⏱️ Профайлер стадий кадра. Выключен по умолчанию: тогда PROFILE_SCOPE — одна проверка флага,
+// без чтения часов. Включённый пишет события в кольцевой буфер своего потока (без блокировок),
+// копит время стадий за кадр и держит окно последних кадров для p50/p99.
+enum class Stage : uint8_t {
+    Frame,    // весь кадр (от одного nextFrame() до следующего)
+    Script,   // 📜 сценарии
+    Animate,  // 🎬 дорожки анимаций
+    Cull,     // ✂️ отсечение по BVH
+    Project,  // 📐 проекция точек
+    Shade,    // 💡 освещение точек
+    Shadow,   // 🌑 карта теней
+    Raster,   // 🧱 раскладка и растеризация
+    Sort,     // 🔢 сортировка полупрозрачного по глубине
+    Tile,     // 🧱 одна плитка растеризатора (на рабочих потоках)
+    Present,  // 🖥️ вывод кадра на экран
+    Count
+};
+
+const char* stageName(Stage stage);
+
+struct ProfileEvent {
+    uint64_t startNs;
+    uint64_t durationNs;
+    uint32_t frame;
+    Stage stage;
+};
+
+// 📊 Окно последних кадров одной стадии (время за кадр, суммой по всем потокам)
+struct StageStats {
+    size_t samples = 0;
+    double p50Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+};
+
+class Profiler {
+public:
+    static constexpr size_t RING_CAPACITY = 1 << 16; // событий на поток — старые перезаписываются
+    static constexpr size_t STATS_WINDOW = 240;      // кадров в окне p50/p99
+
+    Profiler();
+
+    void setEnabled(bool value) { enabled.store(value, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    uint64_t now() const {
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+    }
+
+    // ✍️ Записать событие в буфер вызывающего потока
+    void record(Stage stage, uint64_t startNs, uint64_t durationNs);
+
+    // 🔁 Граница кадров — вызывать из потока рендера, раз в кадр, сразу после вывода на экран
+    void nextFrame();
+    uint32_t frameIndex() const { return frame.load(std::memory_order_relaxed); }
+
+    StageStats stats(Stage stage) const;
+    std::string statsReport() const; // 📋 таблица p50/p99 по стадиям
+
+    // 💾 Все события из буферов в формате Chrome trace (chrome://tracing, Perfetto)
+    bool exportChromeTrace(const std::string& path) const;
+
+private:
+    struct Ring {
+        uint32_t thread = 0;
+        std::atomic<uint64_t> head{ 0 }; // всего записано событий; пишет только поток-владелец
+        std::vector<ProfileEvent> events = std::vector<ProfileEvent>(RING_CAPACITY);
+    };
+    Ring& threadRing();
+
+    std::atomic<bool> enabled{ false };
+    std::chrono::steady_clock::time_point epoch;
+    std::atomic<uint32_t> frame{ 0 };
+    uint64_t frameStart = 0;
+
+    std::array<std::atomic<uint64_t>, size_t(Stage::Count)> frameTotals{}; // нс стадии в текущем кадре
+
+    mutable std::mutex statsMutex; // окно p50/p99: пишет nextFrame(), читает stats()
+    std::array<std::array<float, STATS_WINDOW>, size_t(Stage::Count)> window{};
+    size_t windowCount = 0, windowPos = 0;
+
+    mutable std::mutex ringsMutex; // только регистрация нового потока и экспорт
+    std::vector<std::unique_ptr<Ring>> rings;
+};
+
+Profiler& profiler();
+
+// 🎯 Замер области видимости: PROFILE_SCOPE(Stage::Cull);
+class ProfileScope {
+public:
+    explicit ProfileScope(Stage stage) : stage(stage) {
+        Profiler& p = profiler();
+        if (p.isEnabled()) start = p.now();
+    }
+    ~ProfileScope() {
+        if (start != NOT_STARTED) {
+            Profiler& p = profiler();
+            p.record(stage, start, p.now() - start);
+        }
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    static constexpr uint64_t NOT_STARTED = ~0ull;
+    Stage stage;
+    uint64_t start = NOT_STARTED;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(stage) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(stage)
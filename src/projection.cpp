@@ -0,0 +1,234 @@
+// projection.cpp
+#include "projection.hpp"
+#include "core.hpp"
+
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) // SSE2 здесь есть всегда
+    #define PROJECTION_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #endif
+#endif
+
+// GCC/Clang собирают AVX2-ядро для конкретной функции, без -mavx2 на весь проект
+#if defined(PROJECTION_X86) && (defined(__GNUC__) || defined(__clang__))
+    #define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+    #define TARGET_AVX2
+#endif
+
+#define DEG2RAD(angleDegrees) ((angleDegrees) * 3.14159265f / 180.0f)
+
+ViewProjection makeViewProjection(const Camera& camera, float scale, int width, int height) {
+    // 📌 Те же повороты, что были в draw3DPoint: сначала по горизонтали, потом по вертикали
+    float h = DEG2RAD(-camera.horizontalAngle);
+    float v = DEG2RAD(-camera.verticalAngle);
+    float ch = std::cos(h), sh = std::sin(h);
+    float cv = std::cos(v), sv = std::sin(v);
+
+    ViewProjection vp;
+    const float rot[9] = {
+        ch,        0.0f, -sh,
+        -sv * sh,  cv,   -sv * ch,
+        cv * sh,   sv,    cv * ch,
+    };
+    for (int row = 0; row < 3; ++row) {
+        vp.m[row * 4 + 0] = rot[row * 3 + 0];
+        vp.m[row * 4 + 1] = rot[row * 3 + 1];
+        vp.m[row * 4 + 2] = rot[row * 3 + 2];
+        // сдвиг: -R * позиция камеры
+        vp.m[row * 4 + 3] = -(rot[row * 3 + 0] * camera.x + rot[row * 3 + 1] * camera.y + rot[row * 3 + 2] * camera.z);
+    }
+
+    vp.scale = scale;
+    vp.centerX = float(width / 2);
+    vp.centerY = float(height / 2);
+    vp.width = float(width);
+    vp.height = float(height);
+    return vp;
+}
+
+ViewProjection withTransform(const ViewProjection& vp, const Transform& model) {
+    if (model.isIdentity()) return vp;
+
+    // 📌 world = R_y(rotationY) * scale * p + сдвиг; положительный угол — в ту же сторону, что и у камеры
+    float a = DEG2RAD(-model.rotationY);
+    float c = std::cos(a) * model.scale, s = std::sin(a) * model.scale;
+    const float local[9] = {
+        c,    0.0f,        s,
+        0.0f, model.scale, 0.0f,
+        -s,   0.0f,        c,
+    };
+    const float offset[3] = { model.x, model.y, model.z };
+
+    ViewProjection out = vp;
+    for (int row = 0; row < 3; ++row) {
+        const float* r = vp.m + row * 4;
+        for (int col = 0; col < 3; ++col)
+            out.m[row * 4 + col] = r[0] * local[col] + r[1] * local[3 + col] + r[2] * local[6 + col];
+        out.m[row * 4 + 3] = r[0] * offset[0] + r[1] * offset[1] + r[2] * offset[2] + r[3];
+    }
+    return out;
+}
+
+// ───── Скалярное ядро (и хвосты векторных) ─────
+
+static void projectScalar(const ViewProjection& vp,
+                          const float* x, const float* y, const float* z, size_t begin, size_t end,
+                          float* sx, float* sy, float* depth, uint8_t* visible) {
+    const float* m = vp.m;
+    for (size_t i = begin; i < end; ++i) {
+        float vx = m[0] * x[i] + m[1] * y[i] + m[2]  * z[i] + m[3];
+        float vy = m[4] * x[i] + m[5] * y[i] + m[6]  * z[i] + m[7];
+        float vz = m[8] * x[i] + m[9] * y[i] + m[10] * z[i] + m[11];
+
+        // маска вместо раннего return: цикл остаётся прямым и векторизуемым
+        bool in = vz > vp.nearZ;
+        float k = in ? vp.scale / vz : 0.0f;
+        sx[i] = in ? vx * k + vp.centerX : 0.0f;
+        sy[i] = in ? -vy * k + vp.centerY : 0.0f;
+        depth[i] = in ? vz : 0.0f;
+        visible[i] = uint8_t(in);
+    }
+}
+
+#ifdef PROJECTION_X86
+
+// ───── SSE2: 4 точки за шаг ─────
+
+static size_t projectSSE2(const ViewProjection& vp,
+                          const float* x, const float* y, const float* z, size_t count,
+                          float* sx, float* sy, float* depth, uint8_t* visible) {
+    const float* m = vp.m;
+    const __m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m2  = _mm_set1_ps(m[2]),  m3  = _mm_set1_ps(m[3]);
+    const __m128 m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]), m6  = _mm_set1_ps(m[6]),  m7  = _mm_set1_ps(m[7]);
+    const __m128 m8 = _mm_set1_ps(m[8]), m9 = _mm_set1_ps(m[9]), m10 = _mm_set1_ps(m[10]), m11 = _mm_set1_ps(m[11]);
+    const __m128 scale = _mm_set1_ps(vp.scale);
+    const __m128 cx = _mm_set1_ps(vp.centerX), cy = _mm_set1_ps(vp.centerY);
+    const __m128 nearZ = _mm_set1_ps(vp.nearZ);
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 px = _mm_loadu_ps(x + i), py = _mm_loadu_ps(y + i), pz = _mm_loadu_ps(z + i);
+
+        __m128 vx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, px), _mm_mul_ps(m1, py)), _mm_add_ps(_mm_mul_ps(m2, pz), m3));
+        __m128 vy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m4, px), _mm_mul_ps(m5, py)), _mm_add_ps(_mm_mul_ps(m6, pz), m7));
+        __m128 vz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m8, px), _mm_mul_ps(m9, py)), _mm_add_ps(_mm_mul_ps(m10, pz), m11));
+
+        __m128 mask = _mm_cmpgt_ps(vz, nearZ);
+        // ⚠️ делим на «безопасную» глубину: у отброшенных точек вместо z подставляем 1
+        __m128 safeZ = _mm_or_ps(_mm_and_ps(mask, vz), _mm_andnot_ps(mask, one));
+        __m128 k = _mm_div_ps(scale, safeZ);
+
+        __m128 outX = _mm_add_ps(_mm_mul_ps(vx, k), cx);
+        __m128 outY = _mm_sub_ps(cy, _mm_mul_ps(vy, k));
+
+        _mm_storeu_ps(sx + i, _mm_and_ps(mask, outX));
+        _mm_storeu_ps(sy + i, _mm_and_ps(mask, outY));
+        _mm_storeu_ps(depth + i, _mm_and_ps(mask, vz));
+
+        int bits = _mm_movemask_ps(mask);
+        for (int lane = 0; lane < 4; ++lane)
+            visible[i + lane] = uint8_t((bits >> lane) & 1);
+    }
+    return i;
+}
+
+// ───── AVX2 + FMA: 8 точек за шаг ─────
+
+TARGET_AVX2
+static size_t projectAVX2(const ViewProjection& vp,
+                          const float* x, const float* y, const float* z, size_t count,
+                          float* sx, float* sy, float* depth, uint8_t* visible) {
+    const float* m = vp.m;
+    const __m256 m0 = _mm256_set1_ps(m[0]), m1 = _mm256_set1_ps(m[1]), m2  = _mm256_set1_ps(m[2]),  m3  = _mm256_set1_ps(m[3]);
+    const __m256 m4 = _mm256_set1_ps(m[4]), m5 = _mm256_set1_ps(m[5]), m6  = _mm256_set1_ps(m[6]),  m7  = _mm256_set1_ps(m[7]);
+    const __m256 m8 = _mm256_set1_ps(m[8]), m9 = _mm256_set1_ps(m[9]), m10 = _mm256_set1_ps(m[10]), m11 = _mm256_set1_ps(m[11]);
+    const __m256 scale = _mm256_set1_ps(vp.scale);
+    const __m256 cx = _mm256_set1_ps(vp.centerX), cy = _mm256_set1_ps(vp.centerY);
+    const __m256 nearZ = _mm256_set1_ps(vp.nearZ);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 px = _mm256_loadu_ps(x + i), py = _mm256_loadu_ps(y + i), pz = _mm256_loadu_ps(z + i);
+
+        __m256 vx = _mm256_fmadd_ps(m0, px, _mm256_fmadd_ps(m1, py, _mm256_fmadd_ps(m2, pz, m3)));
+        __m256 vy = _mm256_fmadd_ps(m4, px, _mm256_fmadd_ps(m5, py, _mm256_fmadd_ps(m6, pz, m7)));
+        __m256 vz = _mm256_fmadd_ps(m8, px, _mm256_fmadd_ps(m9, py, _mm256_fmadd_ps(m10, pz, m11)));
+
+        __m256 mask = _mm256_cmp_ps(vz, nearZ, _CMP_GT_OQ);
+        __m256 safeZ = _mm256_blendv_ps(one, vz, mask);
+        __m256 k = _mm256_div_ps(scale, safeZ);
+
+        __m256 outX = _mm256_fmadd_ps(vx, k, cx);
+        __m256 outY = _mm256_fnmadd_ps(vy, k, cy);
+
+        _mm256_storeu_ps(sx + i, _mm256_and_ps(mask, outX));
+        _mm256_storeu_ps(sy + i, _mm256_and_ps(mask, outY));
+        _mm256_storeu_ps(depth + i, _mm256_and_ps(mask, vz));
+
+        int bits = _mm256_movemask_ps(mask);
+        for (int lane = 0; lane < 8; ++lane)
+            visible[i + lane] = uint8_t((bits >> lane) & 1);
+    }
+    return i;
+}
+
+static bool cpuHasAVX2() {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool fma = (info[2] & (1 << 12)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!fma || !osxsave || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+#endif // PROJECTION_X86
+
+enum class ProjectionKernel { Scalar, SSE2, AVX2 };
+
+// 🔹 Выбор ядра — один раз за процесс
+static ProjectionKernel selectKernel() {
+#ifdef PROJECTION_X86
+    static const ProjectionKernel kernel = cpuHasAVX2() ? ProjectionKernel::AVX2 : ProjectionKernel::SSE2;
+    return kernel;
+#else
+    return ProjectionKernel::Scalar;
+#endif
+}
+
+void projectPoints(const ViewProjection& vp,
+                   const float* x, const float* y, const float* z, size_t count,
+                   float* sx, float* sy, float* depth, uint8_t* visible) {
+    size_t done = 0;
+#ifdef PROJECTION_X86
+    switch (selectKernel()) {
+        case ProjectionKernel::AVX2: done = projectAVX2(vp, x, y, z, count, sx, sy, depth, visible); break;
+        case ProjectionKernel::SSE2: done = projectSSE2(vp, x, y, z, count, sx, sy, depth, visible); break;
+        default: break;
+    }
+#endif
+    projectScalar(vp, x, y, z, done, count, sx, sy, depth, visible);
+}
+
+const char* projectionKernelName() {
+    switch (selectKernel()) {
+        case ProjectionKernel::AVX2: return "avx2";
+        case ProjectionKernel::SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
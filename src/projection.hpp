@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Camera; // 🎥 см. core.hpp
+struct Transform; // 🧭 см. core.hpp
+
+// 📐 Матрица вида + параметры проекции. Строится ОДИН раз за кадр —
+// синусы/косинусы углов камеры больше не считаются на каждую точку.
+struct ViewProjection {
+    // мир → вид, 3x4 по строкам: (x1, y1, z2) = M * (x, y, z, 1), z2 — глубина
+    float m[12] = { 1, 0, 0, 0,
+                    0, 1, 0, 0,
+                    0, 0, 1, 0 };
+    float scale = 1.0f;   // логические единицы → пиксели (App::scale, уже включает focalLengthMM)
+    float centerX = 0.0f; // центр экрана в пикселях
+    float centerY = 0.0f;
+    float width = 0.0f;   // размер экрана в пикселях — для пирамиды видимости
+    float height = 0.0f;
+    float nearZ = 0.01f;  // ⚠️ всё, что ближе (или позади камеры), отбрасывается
+
+    // 🔹 Только поворот+сдвиг камеры, без проекции
+    void toView(float x, float y, float z, float& vx, float& vy, float& vz) const {
+        vx = m[0] * x + m[1] * y + m[2]  * z + m[3];
+        vy = m[4] * x + m[5] * y + m[6]  * z + m[7];
+        vz = m[8] * x + m[9] * y + m[10] * z + m[11];
+    }
+
+    // 🔹 Одна точка (скалярно). false — точка за ближней плоскостью
+    bool project(float x, float y, float z, float& sx, float& sy, float& depth) const {
+        float vx, vy;
+        toView(x, y, z, vx, vy, depth);
+        if (depth <= nearZ) return false;
+        float k = scale / depth;
+        sx = vx * k + centerX;
+        sy = -vy * k + centerY;
+        return true;
+    }
+};
+
+// 🎥 Камера (углы в градусах) + масштаб + размер окна → матрица кадра
+ViewProjection makeViewProjection(const Camera& camera, float scale, int width, int height);
+
+// 🧭 Матрица кадра для модели со своим положением: точки модели → сразу в пространство вида
+ViewProjection withTransform(const ViewProjection& vp, const Transform& model);
+
+// 🚀 Пакетная проекция массивов координат в пиксели.
+// visible[i] = 1, если точка перед ближней плоскостью (маска, без ветвлений);
+// для невидимых точек sx/sy/depth = 0. Внутри — AVX2/SSE с выбором во время работы, иначе скаляр.
+void projectPoints(const ViewProjection& vp,
+                   const float* x, const float* y, const float* z, size_t count,
+                   float* sx, float* sy, float* depth, uint8_t* visible);
+
+// 🧺 Переиспользуемые буферы результата — после первого кадра без аллокаций
+struct ProjectedPoints {
+    std::vector<float> x, y, depth;
+    std::vector<uint8_t> visible;
+
+    void resize(size_t count) {
+        if (x.size() >= count) return;
+        x.resize(count);
+        y.resize(count);
+        depth.resize(count);
+        visible.resize(count);
+    }
+};
+
+const char* projectionKernelName(); // "avx2" / "sse2" / "scalar" — для логов и бенчмарков
@@ -0,0 +1,96 @@
+// radix_sort.cpp
+#include "radix_sort.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <array>
+
+static const size_t RADIX_MIN_CHUNK = 16384; // 🔹 меньше — потокам нечего делить, считаем одним куском
+
+void radixSortPairs(std::vector<uint32_t>& keys, std::vector<uint32_t>& values,
+                    std::vector<uint32_t>& keysOut, std::vector<uint32_t>& valuesOut,
+                    unsigned keyBits, ThreadPool& pool) {
+    const size_t n = keys.size();
+    if (n < 2) return;
+
+    const size_t chunks = std::max<size_t>(1, std::min<size_t>(pool.size(), n / RADIX_MIN_CHUNK));
+    const size_t chunkSize = (n + chunks - 1) / chunks;
+
+    keysOut.resize(n);
+    valuesOut.resize(n);
+    std::vector<std::array<uint32_t, 256>> offsets(chunks);
+
+    for (unsigned shift = 0; shift < std::min(keyBits, 32u); shift += 8) {
+        // 📊 Гистограммы кусков
+        pool.parallelFor(chunks, [&](size_t c) {
+            auto& histogram = offsets[c];
+            histogram.fill(0);
+            size_t end = std::min(n, (c + 1) * chunkSize);
+            for (size_t i = c * chunkSize; i < end; ++i)
+                ++histogram[(keys[i] >> shift) & 0xFF];
+        });
+
+        // ➕ Начало каждой корзины каждого куска: по цифрам, внутри цифры — по кускам (устойчивость)
+        uint32_t total = 0;
+        bool single = false;
+        for (size_t digit = 0; digit < 256; ++digit) {
+            uint32_t inDigit = 0;
+            for (size_t c = 0; c < chunks; ++c) {
+                uint32_t count = offsets[c][digit];
+                offsets[c][digit] = total;
+                total += count;
+                inDigit += count;
+            }
+            if (inDigit == n) single = true;
+        }
+        if (single) continue; // ⏭️ все ключи с одной цифрой — проход ничего не меняет
+
+        // 📦 Раскладка
+        pool.parallelFor(chunks, [&](size_t c) {
+            auto& next = offsets[c];
+            size_t end = std::min(n, (c + 1) * chunkSize);
+            for (size_t i = c * chunkSize; i < end; ++i) {
+                uint32_t at = next[(keys[i] >> shift) & 0xFF]++;
+                keysOut[at] = keys[i];
+                valuesOut[at] = values[i];
+            }
+        });
+        keys.swap(keysOut);
+        values.swap(valuesOut);
+    }
+}
+
+void CoherentSort::sort(const uint32_t* keys, size_t count, unsigned keyBits, ThreadPool& pool) {
+    lastReused = false;
+
+    // 🎞️ Тот же размер — пробуем вчерашний порядок: вставки с бюджетом на сдвиги
+    if (count == indices.size() && count > 0) {
+        size_t budget = count / 4 + 64;
+        size_t moves = 0;
+        bool ok = true;
+        for (size_t i = 1; i < count && ok; ++i) {
+            uint32_t item = indices[i];
+            uint32_t key = keys[item];
+            size_t j = i;
+            while (j > 0 && keys[indices[j - 1]] > key) {
+                indices[j] = indices[j - 1];
+                --j;
+                if (++moves > budget) {
+                    ok = false;
+                    break;
+                }
+            }
+            indices[j] = item;
+        }
+        if (ok) {
+            lastReused = true;
+            return;
+        }
+    }
+
+    // 🔢 С нуля: пары (ключ, индекс)
+    indices.resize(count);
+    sortKeys.assign(keys, keys + count);
+    for (size_t i = 0; i < count; ++i) indices[i] = uint32_t(i);
+    radixSortPairs(sortKeys, indices, keysScratch, indicesScratch, keyBits, pool);
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+// 🔢 Параллельная LSD-сортировка по 8 бит: пары (ключ, значение) по возрастанию ключа, устойчиво.
+// Массив режется на куски по потокам пула: гистограммы кусков считаются параллельно, общая префиксная
+// сумма — последовательно (256 x кусков), раскладка — снова параллельно. keyBits — сколько младших
+// бит ключа значимы (лишние проходы не делаются); проход, где все ключи в одной корзине, пропускается.
+// keysScratch/valuesScratch — рабочие буферы, переиспользуются между вызовами
+void radixSortPairs(std::vector<uint32_t>& keys, std::vector<uint32_t>& values,
+                    std::vector<uint32_t>& keysScratch, std::vector<uint32_t>& valuesScratch,
+                    unsigned keyBits, ThreadPool& pool);
+
+// 🎞️ Порядок по глубине с учётом прошлого кадра. Камера сдвинулась чуть-чуть — вчерашний порядок
+// почти верен: применяем его и досортировываем вставками (O(n + перестановок)). Слишком много
+// перестановок (или другое число элементов) — честная поразрядная сортировка
+class CoherentSort {
+public:
+    // 🔹 order() после вызова — индексы 0..count-1 по возрастанию keys[i] (равные — в прошлом порядке)
+    void sort(const uint32_t* keys, size_t count, unsigned keyBits, ThreadPool& pool);
+
+    const std::vector<uint32_t>& order() const { return indices; }
+    bool reused() const { return lastReused; } // 🎞️ прошлый кадр пригодился
+
+private:
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> sortKeys, keysScratch, indicesScratch; // 🧺 буферы поразрядной сортировки
+    bool lastReused = false;
+};
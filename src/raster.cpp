@@ -0,0 +1,495 @@
+// raster.cpp
+#include "raster.hpp"
+#include "mesh.hpp"
+#include "profiler.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// 🎨 Цвет ↔ компоненты (для интерполяции вдоль отрезков и по треугольникам)
+static inline float channel(uint32_t color, int shift) { return float((color >> shift) & 0xFF); }
+
+static inline uint32_t lerpColor(uint32_t a, uint32_t b, float t) {
+    auto mix = [&](int shift) { return uint8_t(channel(a, shift) + (channel(b, shift) - channel(a, shift)) * t + 0.5f); };
+    return packRGBA(mix(16), mix(8), mix(0), mix(24));
+}
+
+static inline bool isOpaque(uint32_t color) { return (color >> 24) == 0xFF; }
+
+// 📐 Вершина в пространстве вида (уже перед ближней плоскостью) → пиксели
+static inline void projectView(const ViewProjection& vp, float vx, float vy, float vz,
+                               float& sx, float& sy) {
+    float k = vp.scale / vz;
+    sx = vx * k + vp.centerX;
+    sy = -vy * k + vp.centerY;
+}
+
+// 🎨 Цвет вершины (0xAARRGGBB, alpha — из opacity; освещённый, если задан setShading) с оттенком экземпляра;
+// без оттенка — ни одного умножения
+uint32_t Rasterizer::vertexColor(const Mesh& mesh, uint32_t i) const {
+    uint8_t alpha = settings.transparency == Transparency::Opaque ? 255 : opacityToAlpha(mesh.opacity[i]);
+    uint8_t r = mesh.r[i], g = mesh.g[i], b = mesh.b[i];
+    if (shading) {
+        r = uint8_t(shading[i] >> 16);
+        g = uint8_t(shading[i] >> 8);
+        b = uint8_t(shading[i]);
+    }
+    if (tint == 0xFFFFFF) return packRGBA(r, g, b, alpha);
+    auto mul = [&](uint8_t c, int shift) { return uint8_t((uint32_t(c) * ((tint >> shift) & 0xFF) + 127) / 255); };
+    return packRGBA(mul(r, 16), mul(g, 8), mul(b, 0), alpha);
+}
+
+void Rasterizer::begin(int frameWidth, int frameHeight) {
+    width = frameWidth;
+    height = frameHeight;
+
+    int ts = std::max(8, settings.tileSize);
+    tilesX = (width + ts - 1) / ts;
+    tilesY = (height + ts - 1) / ts;
+    bins.resize(size_t(tilesX) * tilesY);
+    for (auto& bin : bins) bin.clear();
+
+    points.clear();
+    lines.clear();
+    triangles.clear();
+    translucent.clear();
+}
+
+// ───── Сборка примитивов ─────
+
+void Rasterizer::submitMesh(const ViewProjection& vp, const Mesh& mesh, const ProjectedPoints& proj) {
+    // 🔹 Все полигоны, а линии и точки — целиком, включая не попавшие ни в один полигон
+    if (settings.filled) {
+        for (size_t p = 0; p < mesh.polygonCount(); ++p)
+            submitFill(vp, mesh, proj, uint32_t(p));
+    }
+    if (settings.wireframe)
+        submitLines(vp, mesh, proj, 0, uint32_t(mesh.lineCount()));
+    if (settings.points)
+        submitPoints(mesh, proj, 0, uint32_t(mesh.pointCount()));
+}
+
+void Rasterizer::submitMesh(const ViewProjection& vp, const Mesh& mesh, const ProjectedPoints& proj,
+                            const uint32_t* polygons, size_t polygonCount) {
+    // 🔹 Тот же порядок проходов, что и для всей модели: заливка, рёбра, точки
+    if (settings.filled) {
+        for (size_t k = 0; k < polygonCount; ++k)
+            submitFill(vp, mesh, proj, polygons[k]);
+    }
+    if (settings.wireframe) {
+        for (size_t k = 0; k < polygonCount; ++k)
+            submitLines(vp, mesh, proj, mesh.polygonLineBegin(polygons[k]), mesh.polygonLineEnd(polygons[k]));
+    }
+    if (settings.points) {
+        for (size_t k = 0; k < polygonCount; ++k)
+            submitPoints(mesh, proj, mesh.polygonPointBegin(polygons[k]), mesh.polygonPointEnd(polygons[k]));
+    }
+}
+
+// 🔷 Полигон — веером треугольников по всем его точкам
+void Rasterizer::submitFill(const ViewProjection& vp, const Mesh& mesh, const ProjectedPoints& proj, uint32_t polygon) {
+    uint32_t begin = mesh.polygonPointBegin(polygon), end = mesh.polygonPointEnd(polygon);
+    if (end - begin >= 3) addPolygon(vp, mesh, proj, begin, end);
+}
+
+// 📏 Отрезки между соседними точками линий [first, last)
+void Rasterizer::submitLines(const ViewProjection& vp, const Mesh& mesh, const ProjectedPoints& proj,
+                             uint32_t first, uint32_t last) {
+    for (uint32_t l = first; l < last; ++l) {
+        uint32_t begin = mesh.lineBegin(l), end = mesh.lineEnd(l);
+        for (uint32_t i = begin; i + 1 < end; ++i)
+            addSegment(vp, mesh, proj, i, i + 1);
+    }
+}
+
+// 📍 Точки [first, last) — сразу в корзину своей плитки
+void Rasterizer::submitPoints(const Mesh& mesh, const ProjectedPoints& proj, uint32_t first, uint32_t last) {
+    const int ts = std::max(8, settings.tileSize);
+    for (uint32_t i = first; i < last; ++i) {
+        if (!proj.visible[i]) continue;
+        if (!(proj.x[i] >= 0.0f && proj.y[i] >= 0.0f && proj.x[i] < float(width) && proj.y[i] < float(height))) continue;
+        int px = int(std::floor(proj.x[i])), py = int(std::floor(proj.y[i]));
+        if (px >= width || py >= height) continue;
+
+        uint32_t color = vertexColor(mesh, i);
+        uint32_t index = uint32_t(points.size());
+        if (isOpaque(color))
+            bins[size_t(py / ts) * tilesX + px / ts].points.push_back(index);
+        else
+            translucent.push_back({ index, Kind::Point, proj.depth[i], px / ts, py / ts, px / ts, py / ts });
+        points.push_back({ proj.x[i], proj.y[i], proj.depth[i], color });
+    }
+}
+
+void Rasterizer::addSegment(const ViewProjection& vp, const Mesh& mesh, const ProjectedPoints& proj,
+                            uint32_t i, uint32_t j) {
+    bool vi = proj.visible[i] != 0, vj = proj.visible[j] != 0;
+    if (!vi && !vj) return; // ⚠️ целиком за ближней плоскостью
+
+    uint32_t ci = vertexColor(mesh, i);
+    uint32_t cj = vertexColor(mesh, j);
+    RasterVertex a = { proj.x[i], proj.y[i], proj.depth[i], ci };
+    RasterVertex b = { proj.x[j], proj.y[j], proj.depth[j], cj };
+
+    if (!vi || !vj) {
+        // ✂️ Пересекает ближнюю плоскость — отсекаем в пространстве вида
+        float ax, ay, az, bx, by, bz;
+        vp.toView(mesh.x[i], mesh.y[i], mesh.z[i], ax, ay, az);
+        vp.toView(mesh.x[j], mesh.y[j], mesh.z[j], bx, by, bz);
+        float t = (vp.nearZ - az) / (bz - az);
+
+        RasterVertex& cut = vi ? b : a;
+        float cx = ax + (bx - ax) * t, cy = ay + (by - ay) * t;
+        projectView(vp, cx, cy, vp.nearZ, cut.x, cut.y);
+        cut.z = vp.nearZ;
+        cut.color = lerpColor(ci, cj, t);
+    }
+    addLine(a, b);
+}
+
+void Rasterizer::addPolygon(const ViewProjection& vp, const Mesh& mesh, const ProjectedPoints& proj,
+                            uint32_t begin, uint32_t end) {
+    bool allVisible = true;
+    for (uint32_t i = begin; i < end && allVisible; ++i)
+        allVisible = proj.visible[i] != 0;
+
+    auto vertex = [&](uint32_t i) {
+        return RasterVertex{ proj.x[i], proj.y[i], proj.depth[i], vertexColor(mesh, i) };
+    };
+
+    if (allVisible) {
+        RasterVertex first = vertex(begin);
+        for (uint32_t i = begin + 1; i + 1 < end; ++i)
+            addTriangle(first, vertex(i), vertex(i + 1));
+        return;
+    }
+
+    // ✂️ Sutherland–Hodgman против ближней плоскости в пространстве вида
+    clipIn.clear();
+    for (uint32_t i = begin; i < end; ++i) {
+        ClipVertex v;
+        vp.toView(mesh.x[i], mesh.y[i], mesh.z[i], v.x, v.y, v.z);
+        uint32_t color = vertexColor(mesh, i);
+        v.r = channel(color, 16);
+        v.g = channel(color, 8);
+        v.b = channel(color, 0);
+        v.a = channel(color, 24);
+        clipIn.push_back(v);
+    }
+
+    clipOut.clear();
+    for (size_t k = 0; k < clipIn.size(); ++k) {
+        const ClipVertex& cur = clipIn[k];
+        const ClipVertex& next = clipIn[(k + 1) % clipIn.size()];
+        bool curIn = cur.z > vp.nearZ, nextIn = next.z > vp.nearZ;
+
+        if (curIn) clipOut.push_back(cur);
+        if (curIn != nextIn) {
+            float t = (vp.nearZ - cur.z) / (next.z - cur.z);
+            clipOut.push_back({ cur.x + (next.x - cur.x) * t, cur.y + (next.y - cur.y) * t, vp.nearZ,
+                                cur.r + (next.r - cur.r) * t, cur.g + (next.g - cur.g) * t, cur.b + (next.b - cur.b) * t,
+                                cur.a + (next.a - cur.a) * t });
+        }
+    }
+    if (clipOut.size() < 3) return;
+
+    auto toRaster = [&](const ClipVertex& v) {
+        RasterVertex out;
+        projectView(vp, v.x, v.y, v.z, out.x, out.y);
+        out.z = v.z;
+        out.color = packRGBA(uint8_t(v.r + 0.5f), uint8_t(v.g + 0.5f), uint8_t(v.b + 0.5f), uint8_t(v.a + 0.5f));
+        return out;
+    };
+    RasterVertex first = toRaster(clipOut[0]);
+    for (size_t k = 1; k + 1 < clipOut.size(); ++k)
+        addTriangle(first, toRaster(clipOut[k]), toRaster(clipOut[k + 1]));
+}
+
+void Rasterizer::binBounds(float minX, float minY, float maxX, float maxY,
+                           int& tx0, int& ty0, int& tx1, int& ty1) const {
+    const int ts = std::max(8, settings.tileSize);
+    tx0 = floorToRange(minX, 0, width - 1) / ts;
+    ty0 = floorToRange(minY, 0, height - 1) / ts;
+    tx1 = std::min(tilesX - 1, floorToRange(maxX, 0, width - 1) / ts);
+    ty1 = std::min(tilesY - 1, floorToRange(maxY, 0, height - 1) / ts);
+}
+
+void Rasterizer::addLine(const RasterVertex& a, const RasterVertex& b) {
+    float minX = std::min(a.x, b.x), maxX = std::max(a.x, b.x);
+    float minY = std::min(a.y, b.y), maxY = std::max(a.y, b.y);
+    if (maxX < 0 || maxY < 0 || minX >= width || minY >= height) return; // вне экрана
+
+    // ⚠️ Огромные координаты (точка у самой ближней плоскости) — сначала зажимаем
+    minX = std::max(minX, -1.0f); minY = std::max(minY, -1.0f);
+    maxX = std::min(maxX, float(width)); maxY = std::min(maxY, float(height));
+
+    int tx0, ty0, tx1, ty1;
+    binBounds(minX, minY, maxX, maxY, tx0, ty0, tx1, ty1);
+
+    uint32_t index = uint32_t(lines.size());
+    lines.push_back({ a, b });
+    if (!isOpaque(a.color) || !isOpaque(b.color)) {
+        translucent.push_back({ index, Kind::Line, 0.5f * (a.z + b.z), tx0, ty0, tx1, ty1 });
+        return;
+    }
+    for (int ty = ty0; ty <= ty1; ++ty)
+        for (int tx = tx0; tx <= tx1; ++tx)
+            bins[size_t(ty) * tilesX + tx].lines.push_back(index);
+}
+
+void Rasterizer::addTriangle(const RasterVertex& a, const RasterVertex& b, const RasterVertex& c) {
+    float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    if (std::fabs(area) < 1e-6f) return; // вырожденный
+
+    float minX = std::min({ a.x, b.x, c.x }), maxX = std::max({ a.x, b.x, c.x });
+    float minY = std::min({ a.y, b.y, c.y }), maxY = std::max({ a.y, b.y, c.y });
+    if (maxX < 0 || maxY < 0 || minX >= width || minY >= height) return;
+
+    minX = std::max(minX, -1.0f); minY = std::max(minY, -1.0f);
+    maxX = std::min(maxX, float(width)); maxY = std::min(maxY, float(height));
+
+    int tx0, ty0, tx1, ty1;
+    binBounds(minX, minY, maxX, maxY, tx0, ty0, tx1, ty1);
+
+    uint32_t index = uint32_t(triangles.size());
+    // 🔹 Храним против часовой (в экранных координатах) — edge-функции всегда >= 0 внутри
+    if (area > 0) triangles.push_back({ { a, b, c } });
+    else triangles.push_back({ { a, c, b } });
+
+    if (!isOpaque(a.color) || !isOpaque(b.color) || !isOpaque(c.color)) {
+        translucent.push_back({ index, Kind::Triangle, (a.z + b.z + c.z) / 3.0f, tx0, ty0, tx1, ty1 });
+        return;
+    }
+
+    for (int ty = ty0; ty <= ty1; ++ty)
+        for (int tx = tx0; tx <= tx1; ++tx)
+            bins[size_t(ty) * tilesX + tx].triangles.push_back(index);
+}
+
+// ───── Полупрозрачное: порядок и корзины ─────
+
+static const unsigned DEPTH_KEY_BITS = 24; // 🔢 3 прохода по 8 бит; 16 млн уровней глубины на кадр
+
+void Rasterizer::binTranslucent(ThreadPool& pool) {
+    PROFILE_SCOPE(Stage::Sort);
+    const size_t n = translucent.size();
+
+    auto bin = [&](uint32_t item) {
+        const TranslucentItem& t = translucent[item];
+        for (int ty = t.ty0; ty <= t.ty1; ++ty)
+            for (int tx = t.tx0; tx <= t.tx1; ++tx)
+                bins[size_t(ty) * tilesX + tx].translucent.push_back(item);
+    };
+
+    if (settings.transparency != Transparency::Sorted) {
+        for (size_t i = 0; i < n; ++i) bin(uint32_t(i)); // ⚡ накоплению порядок не важен
+        return;
+    }
+
+    // 📏 Квантуем глубину в диапазоне кадра: дальний → 0, ближний → 2^24-1 (сортировка по возрастанию = от дальних)
+    float nearest = translucent[0].depth, farthest = nearest;
+    for (const auto& t : translucent) {
+        nearest = std::min(nearest, t.depth);
+        farthest = std::max(farthest, t.depth);
+    }
+    const float levels = float((1u << DEPTH_KEY_BITS) - 1);
+    const float k = farthest > nearest ? levels / (farthest - nearest) : 0.0f;
+    depthKeys.resize(n);
+    for (size_t i = 0; i < n; ++i)
+        depthKeys[i] = uint32_t(std::min(levels, (farthest - translucent[i].depth) * k));
+
+    depthSort.sort(depthKeys.data(), n, DEPTH_KEY_BITS, pool);
+    for (uint32_t item : depthSort.order()) bin(item);
+}
+
+// ───── Растеризация плитки ─────
+
+void Rasterizer::flush(Framebuffer& fb, ThreadPool& pool, const std::vector<ScreenRect>* scissor) {
+    if (fb.width != width || fb.height != height) return; // ⚠️ буфер не того размера
+    if (!translucent.empty()) binTranslucent(pool);
+
+    const int ts = tileSize();
+    pool.parallelFor(bins.size(), [&](size_t tile) {
+        if (scissor) {
+            ScreenRect area = { int(tile % tilesX) * ts, int(tile / tilesX) * ts, 0, 0 };
+            area.x1 = area.x0 + ts;
+            area.y1 = area.y0 + ts;
+            if (std::none_of(scissor->begin(), scissor->end(), [&](const ScreenRect& r) { return r.intersects(area); }))
+                return;
+        }
+        rasterTile(fb, tile);
+    });
+}
+
+// 🔷 Треугольник внутри прямоугольника [x0, x1) x [y0, y1): edge-функции в центрах пикселей,
+// глубина через 1/z (перспективно-корректно). Alpha — интерполировать ли и канал прозрачности
+template <bool Alpha, typename Triangle, typename Plot>
+static void drawTriangle(const Triangle& t, int x0, int y0, int x1, int y1, Plot&& plot) {
+    const auto& a = t.v[0];
+    const auto& b = t.v[1];
+    const auto& c = t.v[2];
+
+    // 🔹 Запас в пиксель с каждой стороны: треугольник целиком вне прямоугольника даёт minX > maxX
+    int minX = std::max(x0, floorToRange(std::min({ a.x, b.x, c.x }), x0 - 1, x1));
+    int maxX = std::min(x1 - 1, ceilToRange(std::max({ a.x, b.x, c.x }), x0 - 1, x1));
+    int minY = std::max(y0, floorToRange(std::min({ a.y, b.y, c.y }), y0 - 1, y1));
+    int maxY = std::min(y1 - 1, ceilToRange(std::max({ a.y, b.y, c.y }), y0 - 1, y1));
+    if (minX > maxX || minY > maxY) return;
+
+    float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    float invArea = 1.0f / area;
+    float iza = 1.0f / a.z, izb = 1.0f / b.z, izc = 1.0f / c.z;
+
+    for (int y = minY; y <= maxY; ++y) {
+        float py = y + 0.5f;
+        for (int x = minX; x <= maxX; ++x) {
+            float px = x + 0.5f;
+            float w0 = (c.x - b.x) * (py - b.y) - (c.y - b.y) * (px - b.x);
+            float w1 = (a.x - c.x) * (py - c.y) - (a.y - c.y) * (px - c.x);
+            float w2 = (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+            if (w0 < 0 || w1 < 0 || w2 < 0) continue;
+
+            float l0 = w0 * invArea, l1 = w1 * invArea, l2 = w2 * invArea;
+            float z = 1.0f / (l0 * iza + l1 * izb + l2 * izc);
+            auto mix = [&](int shift) {
+                return uint8_t(channel(a.color, shift) * l0 + channel(b.color, shift) * l1 + channel(c.color, shift) * l2 + 0.5f);
+            };
+            plot(x, y, z, packRGBA(mix(16), mix(8), mix(0), Alpha ? mix(24) : 0xFF));
+        }
+    }
+}
+
+// 📏 Отрезок: DDA только по участку, попавшему в прямоугольник
+template <typename Line, typename Plot>
+static void drawLine(const Line& l, int x0, int y0, int x1, int y1, Plot&& plot) {
+    float dx = l.b.x - l.a.x, dy = l.b.y - l.a.y;
+
+    // ✂️ Liang–Barsky: параметры t входа/выхода в прямоугольник плитки
+    float t0 = 0.0f, t1 = 1.0f;
+    auto clip = [&](float p, float q) {
+        if (p == 0) return q >= 0;
+        float r = q / p;
+        if (p < 0) { if (r > t1) return false; t0 = std::max(t0, r); }
+        else       { if (r < t0) return false; t1 = std::min(t1, r); }
+        return true;
+    };
+    if (!clip(-dx, l.a.x - x0) || !clip(dx, x1 - l.a.x) ||
+        !clip(-dy, l.a.y - y0) || !clip(dy, y1 - l.a.y))
+        return;
+
+    // 🔹 Шаги считаем в double/int64: концы далеко за экраном дают шагов больше, чем влезает в int
+    double steps = std::max(std::fabs(double(dx)), std::fabs(double(dy)));
+    if (!(steps < 1e15)) return; // inf/NaN или отрезок, который float уже не различает по пикселям
+    int64_t first = int64_t(std::floor(t0 * steps)), last = int64_t(std::ceil(t1 * steps));
+    float iza = 1.0f / l.a.z, izb = 1.0f / l.b.z;
+
+    for (int64_t k = first; k <= last; ++k) {
+        float t = steps > 0 ? std::min(1.0f, float(k / steps)) : 0.0f;
+        int x = floorToRange(l.a.x + dx * t, x0 - 1, x1), y = floorToRange(l.a.y + dy * t, y0 - 1, y1);
+        if (x < x0 || y < y0 || x >= x1 || y >= y1) continue;
+        float z = 1.0f / (iza + (izb - iza) * t);
+        plot(x, y, z, lerpColor(l.a.color, l.b.color, t));
+    }
+}
+
+void Rasterizer::rasterTile(Framebuffer& fb, size_t tile) const {
+    const TileBin& bin = bins[tile];
+    if (bin.points.empty() && bin.lines.empty() && bin.triangles.empty() && bin.translucent.empty()) return;
+    PROFILE_SCOPE(Stage::Tile);
+
+    const int ts = std::max(8, settings.tileSize);
+    const int x0 = int(tile % tilesX) * ts, y0 = int(tile / tilesX) * ts;
+    const int x1 = std::min(x0 + ts, width), y1 = std::min(y0 + ts, height);
+
+    uint32_t* color = fb.color.data();
+    float* depth = fb.depth.data();
+    auto plot = [&](int x, int y, float z, uint32_t c) {
+        size_t at = size_t(y) * width + x;
+        if (z < depth[at]) {
+            depth[at] = z;
+            color[at] = c;
+        }
+    };
+
+    for (uint32_t index : bin.triangles)
+        drawTriangle<false>(triangles[index], x0, y0, x1, y1, plot);
+    for (uint32_t index : bin.lines)
+        drawLine(lines[index], x0, y0, x1, y1, plot);
+
+    // 📍 Точки
+    for (uint32_t index : bin.points) {
+        const RasterPoint& p = points[index];
+        plot(int(std::floor(p.x)), int(std::floor(p.y)), p.z, p.color);
+    }
+
+    if (!bin.translucent.empty())
+        rasterTranslucent(fb, bin, x0, y0, x1, y1);
+}
+
+// 🫧 Второй проход плитки: глубина непрозрачных уже готова — проверяем её, но не пишем
+void Rasterizer::rasterTranslucent(Framebuffer& fb, const TileBin& bin, int x0, int y0, int x1, int y1) const {
+    uint32_t* color = fb.color.data();
+    const float* depth = fb.depth.data();
+
+    auto drawItems = [&](auto&& plot) {
+        for (uint32_t item : bin.translucent) {
+            const TranslucentItem& t = translucent[item];
+            switch (t.kind) {
+                case Kind::Triangle: drawTriangle<true>(triangles[t.primitive], x0, y0, x1, y1, plot); break;
+                case Kind::Line:     drawLine(lines[t.primitive], x0, y0, x1, y1, plot); break;
+                case Kind::Point: {
+                    const RasterPoint& p = points[t.primitive];
+                    plot(int(std::floor(p.x)), int(std::floor(p.y)), p.z, p.color);
+                    break;
+                }
+            }
+        }
+    };
+
+    if (settings.transparency == Transparency::Sorted) {
+        // 🔢 Уже от дальних к ближним — просто «поверх»
+        drawItems([&](int x, int y, float z, uint32_t c) {
+            size_t at = size_t(y) * width + x;
+            if (z < depth[at]) color[at] = blendOver(c, color[at], c >> 24);
+        });
+        return;
+    }
+
+    // ⚡ Weighted blended OIT (McGuire, Bavoil 2013): сумма цветов с весом по глубине и прозрачности
+    // плюс произведение (1 - alpha) — «сколько фона видно». Буферы — на плитку, свои у каждого потока
+    const int tw = x1 - x0, th = y1 - y0;
+    thread_local std::vector<float> accum, reveal;
+    accum.assign(size_t(tw) * th * 4, 0.0f);
+    reveal.assign(size_t(tw) * th, 1.0f);
+
+    drawItems([&](int x, int y, float z, uint32_t c) {
+        if (!(z < depth[size_t(y) * width + x])) return;
+        float a = channel(c, 24) / 255.0f;
+        // 🔹 Вес: ближнее и плотное важнее; масштабы глубины — под сцены в сантиметрах
+        float d = z / 500.0f;
+        float w = a * std::clamp(10.0f / (1e-5f + d * d + std::pow(z / 20000.0f, 6.0f)), 1e-2f, 3e3f);
+        size_t at = size_t(y - y0) * tw + (x - x0);
+        float* acc = &accum[at * 4];
+        acc[0] += channel(c, 16) * a * w; // 🔹 цвет умножен на alpha
+        acc[1] += channel(c, 8) * a * w;
+        acc[2] += channel(c, 0) * a * w;
+        acc[3] += a * w;
+        reveal[at] *= 1.0f - a;
+    });
+
+    for (int y = y0; y < y1; ++y) {
+        for (int x = x0; x < x1; ++x) {
+            size_t at = size_t(y - y0) * tw + (x - x0);
+            if (reveal[at] >= 1.0f) continue;
+            const float* acc = &accum[at * 4];
+            float inv = 1.0f / std::max(acc[3], 1e-5f);
+            float cover = 1.0f - reveal[at];
+            uint32_t& dst = color[size_t(y) * width + x];
+            auto mix = [&](int k, int shift) {
+                return uint8_t(std::min(255.0f, acc[k] * inv * cover + channel(dst, shift) * reveal[at] + 0.5f));
+            };
+            dst = packRGB(mix(0, 16), mix(1, 8), mix(2, 0));
+        }
+    }
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "framebuffer.hpp"
+#include "projection.hpp"
+#include "radix_sort.hpp"
+
+struct Mesh;
+class ThreadPool;
+
+// 📐 Экранная координата → пиксель в [lo, hi]. Зажимаем ещё во float: точка у плоскости
+// отсечения проецируется далеко за экран, и int(floor(x)) для неё — переполнение (UB). NaN → lo
+inline int floorToRange(float v, int lo, int hi) {
+    if (!(v > float(lo))) return lo;
+    if (v >= float(hi)) return hi;
+    return int(std::floor(v));
+}
+inline int ceilToRange(float v, int lo, int hi) {
+    if (!(v > float(lo))) return lo;
+    if (v >= float(hi)) return hi;
+    return int(std::ceil(v));
+}
+
+// 🫧 Как рисовать полупрозрачное (opacity < 1 хотя бы у одной вершины примитива)
+enum class Transparency : uint8_t {
+    Opaque,          // opacity не учитывается — всё непрозрачное
+    Sorted,          // 🔢 от дальних к ближним (поразрядная сортировка по глубине) и смешивание «поверх» — точно
+    WeightedBlended, // ⚡ без сортировки: взвешенное накопление по глубине (McGuire–Bavoil) — быстрее, но приближённо
+};
+
+// ⚙️ Что рисовать
+struct RasterSettings {
+    bool points = true;     // 📍 каждую точку модели
+    bool wireframe = true;  // 📏 отрезки между соседними точками линии
+    bool filled = false;    // 🔷 залитые полигоны (веер треугольников по точкам полигона)
+    int tileSize = 64;      // сторона плитки в пикселях
+    Transparency transparency = Transparency::Sorted;
+};
+
+// 🧱 Растеризатор по плиткам: примитивы сначала отсекаются и раскладываются по корзинам плиток,
+// потом плитки рисуются параллельно — у каждой своя область буфера, без блокировок.
+// Глубина проверяется по Framebuffer::depth (меньше — ближе).
+// Полупрозрачные примитивы рисуются вторым проходом, после всех непрозрачных: глубину проверяют, но не пишут.
+class Rasterizer {
+public:
+    RasterSettings settings;
+
+    // 🔹 Начать кадр размером width x height (корзины чистятся, память остаётся)
+    void begin(int width, int height);
+
+    // 📦 Добавить модель: proj — результат projectPoints для её точек с той же матрицей vp
+    void submitMesh(const ViewProjection& vp, const Mesh& mesh, const ProjectedPoints& proj);
+
+    // ✂️ Только перечисленные полигоны (их линии и точки) — после отсечения по BVH.
+    // proj достаточно заполнить для точек этих полигонов
+    void submitMesh(const ViewProjection& vp, const Mesh& mesh, const ProjectedPoints& proj,
+                    const uint32_t* polygons, size_t polygonCount);
+
+    // 🎨 Оттенок для следующих submitMesh: цвета вершин умножаются на 0xRRGGBB (белый — как есть)
+    void setTint(uint32_t rgb) { tint = rgb & 0xFFFFFF; }
+
+    // 💡 Освещённые цвета 0xRRGGBB по точке модели (Lighting::shade) вместо своих — для следующих submitMesh.
+    // Массив читается только внутри submitMesh; nullptr — свои цвета точек
+    void setShading(const uint32_t* rgb) { shading = rgb; }
+
+    // 🖌️ Нарисовать всё добавленное в fb (размер fb должен совпадать с begin).
+    // scissor — только плитки, задетые этими прямоугольниками (остальные пиксели fb не трогаются)
+    void flush(Framebuffer& fb, ThreadPool& pool, const std::vector<ScreenRect>* scissor = nullptr);
+
+    int tileSize() const { return std::max(8, settings.tileSize); } // 🔹 сторона плитки, которой режется кадр
+
+    size_t primitiveCount() const { return points.size() + lines.size() + triangles.size(); }
+    size_t translucentCount() const { return translucent.size(); }
+    bool sortReused() const { return depthSort.reused(); } // 🎞️ порядок прошлого кадра подошёл без пересортировки
+
+private:
+    struct RasterPoint { float x, y, z; uint32_t color; };
+    struct RasterVertex { float x, y, z; uint32_t color; };
+    struct RasterLine { RasterVertex a, b; };
+    struct RasterTriangle { RasterVertex v[3]; };
+
+    struct ClipVertex { float x, y, z, r, g, b, a; }; // вершина в пространстве вида — для отсечения
+
+    // 🫧 Полупрозрачный примитив: в корзины плиток попадает только в flush(), уже в нужном порядке
+    enum class Kind : uint8_t { Point, Line, Triangle };
+    struct TranslucentItem {
+        uint32_t primitive; // индекс в points / lines / triangles
+        Kind kind;
+        float depth;        // глубина центра — ключ сортировки
+        int tx0, ty0, tx1, ty1;
+    };
+
+    struct TileBin {
+        std::vector<uint32_t> points, lines, triangles; // индексы примитивов в порядке добавления
+        std::vector<uint32_t> translucent;              // индексы в translucent — в порядке рисования
+        void clear() { points.clear(); lines.clear(); triangles.clear(); translucent.clear(); }
+    };
+
+    uint32_t vertexColor(const Mesh& mesh, uint32_t i) const;
+    void submitFill(const ViewProjection& vp, const Mesh& mesh, const ProjectedPoints& proj, uint32_t polygon);
+    void submitLines(const ViewProjection& vp, const Mesh& mesh, const ProjectedPoints& proj, uint32_t first, uint32_t last);
+    void submitPoints(const Mesh& mesh, const ProjectedPoints& proj, uint32_t first, uint32_t last);
+    void addSegment(const ViewProjection& vp, const Mesh& mesh, const ProjectedPoints& proj, uint32_t i, uint32_t j);
+    void addPolygon(const ViewProjection& vp, const Mesh& mesh, const ProjectedPoints& proj, uint32_t begin, uint32_t end);
+    void addLine(const RasterVertex& a, const RasterVertex& b);
+    void addTriangle(const RasterVertex& a, const RasterVertex& b, const RasterVertex& c);
+    void binBounds(float minX, float minY, float maxX, float maxY, int& tx0, int& ty0, int& tx1, int& ty1) const;
+    void binTranslucent(ThreadPool& pool);
+
+    void rasterTile(Framebuffer& fb, size_t tile) const;
+    void rasterTranslucent(Framebuffer& fb, const TileBin& bin, int x0, int y0, int x1, int y1) const;
+
+    int width = 0, height = 0;
+    uint32_t tint = 0xFFFFFF;
+    const uint32_t* shading = nullptr;
+    int tilesX = 0, tilesY = 0;
+    std::vector<TileBin> bins;
+
+    std::vector<RasterPoint> points;
+    std::vector<RasterLine> lines;
+    std::vector<RasterTriangle> triangles;
+
+    std::vector<TranslucentItem> translucent;
+    std::vector<uint32_t> depthKeys; // 🔢 квантованная глубина: меньше — дальше
+    CoherentSort depthSort;
+
+    // 🧺 Рабочие буферы отсечения полигонов ближней плоскостью
+    std::vector<ClipVertex> clipIn, clipOut;
+};
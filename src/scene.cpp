@@ -0,0 +1,306 @@
+// scene.cpp
+#include "scene.hpp"
+#include "asset_cache.hpp"
+#include "mesh.hpp"
+#include "profiler.hpp"
+#include "script.hpp"
+#include "thread_pool.hpp"
+
+#include "json.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+#define DEG2RAD(angleDegrees) ((angleDegrees) * 3.14159265f / 180.0f)
+
+size_t Scene::add(std::shared_ptr<const Mesh> mesh, const Transform& transform, uint32_t tint) {
+    instances.push_back({ std::move(mesh), transform, tint });
+    return instances.size() - 1;
+}
+
+size_t Scene::uniqueMeshCount() const {
+    std::vector<const Mesh*> meshes;
+    meshes.reserve(instances.size());
+    for (const auto& instance : instances)
+        meshes.push_back(instance.mesh.get());
+    std::sort(meshes.begin(), meshes.end());
+    return size_t(std::unique(meshes.begin(), meshes.end()) - meshes.begin());
+}
+
+// ───── Анимации экземпляров ─────
+
+static const char* const TRANSFORM_PARAMS[5] = { "x", "y", "z", "rotationY", "scale" };
+
+void Scene::bindAnimations(size_t firstInstance, const std::vector<SceneEntry>& entries,
+                           const std::vector<SceneClip>& clips, AnimationSystem& animations, ScriptBindings* bindings) {
+    // 🔹 Имена клипов и параметров → номера один раз, здесь; в кадре только индексы
+    std::unordered_map<std::string, uint32_t> clipIds;
+    for (const SceneClip& clip : clips)
+        clipIds.emplace(clip.name, animations.compileClip(clip.name, clip.keys, clip.loop));
+    for (int k = 0; k < 5; ++k)
+        transformParams[k] = animations.params.intern(TRANSFORM_PARAMS[k]);
+    animations.refreshParams();
+
+    for (size_t e = 0; e < entries.size() && firstInstance + e < instances.size(); ++e) {
+        const SceneEntry& entry = entries[e];
+        if (entry.animation.empty() && entry.name.empty()) continue;
+
+        size_t instance = firstInstance + e;
+        const Transform& t = instances[instance].transform;
+        uint32_t object = animations.addObject();
+        const float start[5] = { t.x, t.y, t.z, t.rotationY, t.scale };
+        for (int k = 0; k < 5; ++k)
+            animations.setValue(object, transformParams[k], start[k]);
+        animated.push_back({ instance, object });
+
+        auto clip = clipIds.find(entry.animation);
+        if (clip != clipIds.end()) animations.play(object, clip->second, entry.animationSpeed);
+        if (bindings && !entry.name.empty()) bindings->bindAnimation(entry.name, animations, object);
+    }
+}
+
+void Scene::applyAnimations(const AnimationSystem& animations) {
+    if (animated.empty()) return;
+    PROFILE_SCOPE(Stage::Animate);
+    for (const Animated& a : animated) {
+        Transform& t = instances[a.instance].transform;
+        t.x = animations.value(a.object, transformParams[0]);
+        t.y = animations.value(a.object, transformParams[1]);
+        t.z = animations.value(a.object, transformParams[2]);
+        t.rotationY = animations.value(a.object, transformParams[3]);
+        t.scale = animations.value(a.object, transformParams[4]);
+    }
+}
+
+AABB transformBounds(const AABB& box, const Transform& transform) {
+    if (box.empty() || transform.isIdentity()) return box;
+
+    // 📌 Та же формула, что и в withTransform: world = R_y(rotationY) * scale * p + сдвиг
+    float a = DEG2RAD(-transform.rotationY);
+    float c = std::cos(a) * transform.scale, s = std::sin(a) * transform.scale;
+
+    AABB out;
+    for (int corner = 0; corner < 8; ++corner) {
+        float x = box.min[0], y = box.min[1], z = box.min[2];
+        if (corner & 1) x = box.max[0];
+        if (corner & 2) y = box.max[1];
+        if (corner & 4) z = box.max[2];
+        out.expand(c * x + s * z + transform.x, transform.scale * y + transform.y, -s * x + c * z + transform.z);
+    }
+    return out;
+}
+
+// ───── Манифест сцены ─────
+
+// 🎬 "animations": [ { "name", "loop", "keys": [ { "time", параметр: число, ... } ] } ]
+static bool readSceneClips(const json& doc, std::vector<SceneClip>& clips, std::string& error) {
+    if (!doc.contains("animations")) return true;
+    if (!doc["animations"].is_array()) {
+        error = "\"animations\" must be an array";
+        return false;
+    }
+    for (const auto& item : doc["animations"]) {
+        std::string where = "animation " + std::to_string(clips.size());
+        if (!item.is_object() || !item.contains("name") || !item["name"].is_string()) {
+            error = where + ": missing \"name\"";
+            return false;
+        }
+        SceneClip clip;
+        clip.name = item["name"].get<std::string>();
+        where = "animation \"" + clip.name + "\"";
+        for (const SceneClip& other : clips) {
+            if (other.name == clip.name) {
+                error = where + ": duplicate name";
+                return false;
+            }
+        }
+        if (item.contains("loop")) {
+            if (!item["loop"].is_boolean()) {
+                error = where + ": \"loop\" must be true or false";
+                return false;
+            }
+            clip.loop = item["loop"].get<bool>();
+        }
+        if (!item.contains("keys") || !item["keys"].is_array() || item["keys"].empty()) {
+            error = where + ": expected a non-empty \"keys\" array";
+            return false;
+        }
+        for (const auto& keyItem : item["keys"]) {
+            if (!keyItem.is_object() || !keyItem.contains("time") || !keyItem["time"].is_number()) {
+                error = where + ": every key needs a numeric \"time\"";
+                return false;
+            }
+            Animation key;
+            key.name = clip.name;
+            key.time = keyItem["time"].get<float>();
+            for (const auto& [param, value] : keyItem.items()) {
+                if (param == "time") continue;
+                if (!value.is_number()) {
+                    error = where + ": parameter \"" + param + "\" must be a number";
+                    return false;
+                }
+                key.parameters.emplace_back(param, value.get<float>());
+            }
+            clip.keys.push_back(std::move(key));
+        }
+        clips.push_back(std::move(clip));
+    }
+    return true;
+}
+
+bool readSceneManifest(const std::string& path, std::vector<SceneEntry>& entries, std::vector<SceneClip>& clips,
+                       std::string& error) {
+    entries.clear();
+    clips.clear();
+    std::ifstream file(path);
+    if (!file) {
+        error = "failed to open file";
+        return false;
+    }
+
+    // 🔹 Манифест маленький (сотни строк) — хватает обычного дерева json, SAX тут не нужен
+    json doc = json::parse(file, nullptr, false);
+    if (doc.is_discarded() || !doc.is_object() || !doc.contains("models") || !doc["models"].is_array()) {
+        error = "expected an object with a \"models\" array";
+        return false;
+    }
+
+    if (!readSceneClips(doc, clips, error)) return false;
+
+    fs::path base = fs::path(path).parent_path();
+    for (const auto& item : doc["models"]) {
+        size_t index = entries.size();
+        if (!item.is_object() || !item.contains("path") || !item["path"].is_string()) {
+            error = "model " + std::to_string(index) + ": missing \"path\"";
+            return false;
+        }
+
+        SceneEntry entry;
+        fs::path file = item["path"].get<std::string>();
+        entry.path = (file.is_absolute() ? file : base / file).string();
+
+        auto number = [&](const char* name, float& out) {
+            if (!item.contains(name)) return true;
+            if (!item[name].is_number()) return false;
+            out = item[name].get<float>();
+            return true;
+        };
+        Transform& t = entry.transform;
+        if (!number("x", t.x) || !number("y", t.y) || !number("z", t.z) ||
+            !number("rotationY", t.rotationY) || !number("scale", t.scale)) {
+            error = "model " + std::to_string(index) + ": transform fields must be numbers";
+            return false;
+        }
+
+        if (item.contains("tint")) {
+            const json& tint = item["tint"];
+            if (!tint.is_array() || tint.size() != 3 || !tint[0].is_number() || !tint[1].is_number() || !tint[2].is_number()) {
+                error = "model " + std::to_string(index) + ": tint must be [r, g, b]";
+                return false;
+            }
+            auto c = [&](size_t k) { return uint32_t(std::clamp(tint[k].get<int>(), 0, 255)); };
+            entry.tint = (c(0) << 16) | (c(1) << 8) | c(2);
+        }
+
+        auto text = [&](const char* name, std::string& out) {
+            if (!item.contains(name)) return true;
+            if (!item[name].is_string()) return false;
+            out = item[name].get<std::string>();
+            return true;
+        };
+        if (!text("name", entry.name) || !text("animation", entry.animation) ||
+            !number("animationSpeed", entry.animationSpeed)) {
+            error = "model " + std::to_string(index) + ": name/animation must be strings, animationSpeed a number";
+            return false;
+        }
+        if (!entry.animation.empty() &&
+            std::none_of(clips.begin(), clips.end(), [&](const SceneClip& clip) { return clip.name == entry.animation; })) {
+            error = "model " + std::to_string(index) + ": unknown animation \"" + entry.animation + "\"";
+            return false;
+        }
+        entries.push_back(std::move(entry));
+    }
+    return true;
+}
+
+// ───── Асинхронная загрузка ─────
+
+void SceneLoader::start(Scene& target, const std::vector<SceneEntry>& entries, AssetCache& assets, ThreadPool& pool,
+                        Callback onLoaded) {
+    scene = &target;
+    groups.clear();
+    state = std::make_shared<State>();
+    state->onLoaded = std::move(onLoaded);
+
+    // 🔹 Один файл — одна задача, сколько бы экземпляров на него ни ссылалось
+    std::vector<std::string> paths;
+    std::unordered_map<std::string, size_t> groupOf;
+    target.instances.reserve(target.instances.size() + entries.size());
+    for (const auto& entry : entries) {
+        auto inserted = groupOf.emplace(AssetCache::key(entry.path), groups.size());
+        if (inserted.second) {
+            groups.emplace_back();
+            paths.push_back(entry.path);
+        }
+        groups[inserted.first->second].push_back(target.add(nullptr, entry.transform, entry.tint));
+    }
+    state->remaining = groups.size();
+
+    for (size_t g = 0; g < paths.size(); ++g) {
+        pool.submit([state = state, &assets, g, path = paths[g]] {
+            std::shared_ptr<const Mesh> mesh;
+            try {
+                mesh = assets.load(path); // 🧩 разбор, коробки, BVH и кэш на диске — здесь, на рабочем потоке
+            } catch (...) {
+                mesh = std::make_shared<const Mesh>();
+            }
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->ready.emplace_back(g, mesh);
+            }
+            // 🔔 Модель уже в ready — разбуженный рендер её заберёт. Счётчик — только после вызова:
+            // wait() не должен вернуться, пока onLoaded ещё трогает то, что владелец сейчас закроет
+            if (state->onLoaded) state->onLoaded(path, mesh);
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                --state->remaining;
+            }
+            state->done.notify_all();
+        });
+    }
+}
+
+size_t SceneLoader::poll() {
+    if (!state) return 0;
+    std::vector<std::pair<size_t, std::shared_ptr<const Mesh>>> ready;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        ready.swap(state->ready);
+    }
+
+    size_t shown = 0;
+    for (auto& item : ready) {
+        for (size_t instance : groups[item.first])
+            scene->instances[instance].mesh = item.second;
+        shown += groups[item.first].size();
+    }
+    return shown;
+}
+
+void SceneLoader::wait() {
+    if (!state) return;
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&] { return state->remaining == 0; });
+}
+
+bool SceneLoader::finished() const {
+    if (!state) return true;
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->remaining == 0 && state->ready.empty();
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "bvh.hpp"
+#include "core.hpp"
+
+class AssetCache;
+class ScriptBindings;
+class ThreadPool;
+
+const uint32_t TINT_NONE = 0xFFFFFF; // 🎨 множитель цвета 0xRRGGBB: белый — цвета модели как есть
+
+// 🧩 Экземпляр модели: только положение и оттенок, геометрия общая (из AssetCache)
+struct Instance {
+    std::shared_ptr<const Mesh> mesh;
+    Transform transform;
+    uint32_t tint = TINT_NONE;
+};
+
+struct SceneEntry;
+struct SceneClip;
+
+// 🌍 Сцена — список экземпляров. Память растёт с числом разных моделей, а не экземпляров
+class Scene {
+public:
+    std::vector<Instance> instances;
+
+    // 🎬 Экземпляры, чьё положение ведёт объект AnimationSystem (параметры x, y, z, rotationY, scale)
+    struct Animated { size_t instance; uint32_t object; };
+    std::vector<Animated> animated;
+
+    size_t add(std::shared_ptr<const Mesh> mesh, const Transform& transform = Transform(), uint32_t tint = TINT_NONE);
+    size_t uniqueMeshCount() const;
+
+    // 🔨 При загрузке: клипы манифеста → animations, экземплярам entries (начиная с firstInstance)
+    // с "animation" или "name" — свой объект анимации. Параметры положения объекта начинаются
+    // с transform экземпляра; name становится префиксом сценариев (door.rotationY, door.open).
+    // ⚠️ Положение такого экземпляра каждый кадр берётся из параметров — прямые записи в transform
+    // (в том числе model.* сценариев) затираются
+    void bindAnimations(size_t firstInstance, const std::vector<SceneEntry>& entries, const std::vector<SceneClip>& clips,
+                        AnimationSystem& animations, ScriptBindings* bindings = nullptr);
+
+    // ⏱️ После AnimationSystem::update: параметры положения → transform экземпляров (без строк и выделений)
+    void applyAnimations(const AnimationSystem& animations);
+
+private:
+    ParamId transformParams[5] = { INVALID_PARAM, INVALID_PARAM, INVALID_PARAM, INVALID_PARAM, INVALID_PARAM };
+};
+
+// 📦 Мировая коробка модели после transform (по 8 углам — с поворотом коробка растёт)
+AABB transformBounds(const AABB& box, const Transform& transform);
+
+// 📜 Строка манифеста сцены: какой файл и где поставить.
+// Манифест — JSON: { "models": [ { "path": "cube.json", "x": 0, "y": 0, "z": 0,
+//                                  "rotationY": 0, "scale": 1, "tint": [255, 255, 255],
+//                                  "name": "door", "animation": "spin", "animationSpeed": 1 }, ... ],
+//                    "animations": [ { "name": "spin", "loop": true,
+//                                      "keys": [ { "time": 0, "rotationY": 0 }, { "time": 4, "rotationY": 360 } ] } ] }
+// path — относительно файла манифеста; всё, кроме path, необязательно. В ключе клипа всё, кроме time, —
+// значения параметров: x, y, z, rotationY, scale двигают экземпляр, остальные видны только сценариям
+struct SceneEntry {
+    std::string path;
+    Transform transform;
+    uint32_t tint = TINT_NONE;
+    std::string name;           // 🏷️ префикс для сценариев (пусто — экземпляр сценариям не виден)
+    std::string animation;      // 🎬 клип из "animations" (пусто — без анимации)
+    float animationSpeed = 1.0f;
+};
+
+// 🎬 Клип манифеста: ключи — в старом формате Animation (время + пары параметр-значение)
+struct SceneClip {
+    std::string name;
+    bool loop = true;
+    std::vector<Animation> keys;
+};
+
+bool readSceneManifest(const std::string& path, std::vector<SceneEntry>& entries, std::vector<SceneClip>& clips,
+                       std::string& error);
+
+// 🚚 Асинхронная загрузка сцены: экземпляры добавляются сразу (без модели — drawScene их пропускает),
+// а каждый уникальный файл грузится отдельной задачей пула. Готовые модели копятся в очереди,
+// и поток рендера между кадрами раздаёт их экземплярам через poll() — сцена появляется по частям.
+// Задачи держат только общее состояние, так что SceneLoader можно уничтожить, не дожидаясь их
+class SceneLoader {
+public:
+    // 🔔 На рабочем потоке, сразу после загрузки файла (например, разбудить цикл окна)
+    using Callback = std::function<void(const std::string& path, const std::shared_ptr<const Mesh>& mesh)>;
+
+    // ⚠️ scene.instances после start() не должны перераспределяться, пока идёт загрузка
+    void start(Scene& scene, const std::vector<SceneEntry>& entries, AssetCache& assets, ThreadPool& pool,
+               Callback onLoaded = Callback());
+
+    size_t poll();          // 🔁 поток рендера: выдать готовые модели; возвращает число оживших экземпляров
+    void wait();            // ⏳ дождаться всех файлов и их onLoaded (потом всё равно poll())
+    bool finished() const;  // все файлы загружены и розданы
+    size_t fileCount() const { return groups.size(); }
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::condition_variable done;
+        std::vector<std::pair<size_t, std::shared_ptr<const Mesh>>> ready; // (файл, модель)
+        size_t remaining = 0;
+        Callback onLoaded;
+    };
+
+    Scene* scene = nullptr;
+    std::vector<std::vector<size_t>> groups; // экземпляры по уникальным файлам
+    std::shared_ptr<State> state;
+};
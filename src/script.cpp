@@ -0,0 +1,601 @@
+// script.cpp
+#include "script.hpp"
+#include "core.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+// ───── Привязки ─────
+
+void ScriptBindings::bind(const std::string& name, float* value) {
+    for (auto& slot : slots)
+        if (slot.name == name) { slot = Slot{ name, value }; return; }
+    slots.push_back(Slot{ name, value });
+}
+
+void ScriptBindings::bindTransform(const std::string& prefix, Transform& transform) {
+    bind(prefix + ".x", &transform.x);
+    bind(prefix + ".y", &transform.y);
+    bind(prefix + ".z", &transform.z);
+    bind(prefix + ".rotationY", &transform.rotationY);
+    bind(prefix + ".scale", &transform.scale);
+}
+
+void ScriptBindings::bindAnimation(const std::string& prefix, AnimationSystem& animations, uint32_t object) {
+    animationPrefixes.push_back({ prefix + ".", &animations, object });
+}
+
+int ScriptBindings::resolve(const std::string& name) {
+    for (size_t i = 0; i < slots.size(); ++i)
+        if (slots[i].name == name) return int(i);
+
+    // 🎬 door.open → параметр "open" объекта анимации door
+    for (const auto& entry : animationPrefixes) {
+        if (name.size() <= entry.prefix.size() || name.compare(0, entry.prefix.size(), entry.prefix) != 0) continue;
+
+        Slot slot;
+        slot.name = name;
+        slot.animations = entry.animations;
+        slot.object = entry.object;
+        slot.param = entry.animations->params.intern(name.substr(entry.prefix.size()));
+        entry.animations->refreshParams();
+        slots.push_back(std::move(slot));
+        return int(slots.size() - 1);
+    }
+    return -1;
+}
+
+// ───── Встроенные функции ─────
+
+enum Builtin : uint8_t { BUILTIN_SIN, BUILTIN_COS, BUILTIN_SQRT, BUILTIN_ABS, BUILTIN_FLOOR,
+                         BUILTIN_MIN, BUILTIN_MAX, BUILTIN_CLAMP, BUILTIN_LERP, BUILTIN_COUNT };
+
+static const struct { const char* name; int arity; } BUILTINS[BUILTIN_COUNT] = {
+    { "sin", 1 }, { "cos", 1 }, { "sqrt", 1 }, { "abs", 1 }, { "floor", 1 },
+    { "min", 2 }, { "max", 2 }, { "clamp", 3 }, { "lerp", 3 },
+};
+
+// ───── Лексер ─────
+
+namespace {
+
+enum class TokenType { Number, Name, Symbol, End };
+
+struct Token {
+    TokenType type;
+    std::string text;
+    float number = 0.0f;
+    int line = 0;
+};
+
+struct CompileFailure {
+    int line;
+    std::string message;
+};
+
+std::vector<Token> tokenize(const std::string& source) {
+    std::vector<Token> tokens;
+    int line = 1;
+    size_t i = 0, n = source.size();
+
+    while (i < n) {
+        char c = source[i];
+        if (c == '\n') { ++line; ++i; continue; }
+        if (std::isspace(static_cast<unsigned char>(c))) { ++i; continue; }
+        if (c == '#') {
+            while (i < n && source[i] != '\n') ++i;
+            continue;
+        }
+
+        if (std::isdigit(static_cast<unsigned char>(c)) || (c == '.' && i + 1 < n && std::isdigit(static_cast<unsigned char>(source[i + 1])))) {
+            const char* begin = source.c_str() + i;
+            char* end = nullptr;
+            float value = std::strtof(begin, &end);
+            tokens.push_back({ TokenType::Number, std::string(begin, size_t(end - begin)), value, line });
+            i += size_t(end - begin);
+            continue;
+        }
+
+        // 🔹 Имя вместе с точками: cam.x — один токен
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            size_t start = i;
+            while (i < n && (std::isalnum(static_cast<unsigned char>(source[i])) || source[i] == '_' ||
+                             (source[i] == '.' && i + 1 < n && (std::isalpha(static_cast<unsigned char>(source[i + 1])) || source[i + 1] == '_'))))
+                ++i;
+            tokens.push_back({ TokenType::Name, source.substr(start, i - start), 0.0f, line });
+            continue;
+        }
+
+        static const char* twoChar[] = { "<=", ">=", "==", "!=", "+=", "-=", "*=", "/=" };
+        bool matched = false;
+        for (const char* op : twoChar) {
+            if (i + 1 < n && source[i] == op[0] && source[i + 1] == op[1]) {
+                tokens.push_back({ TokenType::Symbol, op, 0.0f, line });
+                i += 2;
+                matched = true;
+                break;
+            }
+        }
+        if (matched) continue;
+
+        if (std::string("+-*/%<>=(){},").find(c) == std::string::npos)
+            throw CompileFailure{ line, std::string("unexpected character '") + c + "'" };
+        tokens.push_back({ TokenType::Symbol, std::string(1, c), 0.0f, line });
+        ++i;
+    }
+    tokens.push_back({ TokenType::End, "", 0.0f, line });
+    return tokens;
+}
+
+// ───── Компилятор: рекурсивный спуск сразу в байткод ─────
+
+const int REGISTER_DT = 0;
+const int REGISTER_TIME = 1;
+const int REGISTER_LIMIT = 256;
+
+class ScriptCompiler {
+public:
+    ScriptCompiler(const std::vector<Token>& tokens, ScriptBindings& bindings,
+                   std::vector<Instruction>& init, std::vector<Instruction>& code, std::vector<float>& constants)
+        : tokens(tokens), bindings(bindings), init(init), code(code), constants(constants), out(&code) {}
+
+    int compile() {
+        reservePersistent();
+        while (peek().type != TokenType::End)
+            statement();
+        return maxRegister;
+    }
+
+private:
+    struct Local { std::string name; int reg; bool persistent; };
+
+    // ── токены ──
+    const Token& peek() const { return tokens[pos]; }
+    const Token& next() { return tokens[pos++]; }
+    bool isSymbol(const char* s) const { return peek().type == TokenType::Symbol && peek().text == s; }
+    bool isKeyword(const char* s) const { return peek().type == TokenType::Name && peek().text == s; }
+    bool accept(const char* s) {
+        if (!isSymbol(s)) return false;
+        ++pos;
+        return true;
+    }
+    void expect(const char* s) {
+        if (!accept(s)) fail(std::string("expected '") + s + "'");
+    }
+    [[noreturn]] void fail(const std::string& message) const { throw CompileFailure{ peek().line, message }; }
+
+    // ── регистры: var внизу (свои на всё время сценария), над ними let и временные — стеком ──
+
+    // 🔹 Регистры var — до любых временных: иначе временные более ранних операторов
+    // каждый кадр затирали бы значение, которое должно дожить до следующего кадра
+    void reservePersistent() {
+        int count = 0;
+        for (const Token& token : tokens)
+            if (token.type == TokenType::Name && token.text == "var") ++count;
+        if (nextRegister + count > REGISTER_LIMIT) fail("too many 'var' variables");
+        nextPersistent = nextRegister;
+        nextRegister += count;
+        maxRegister = std::max(maxRegister, nextRegister);
+    }
+
+    int allocRegister() {
+        if (nextRegister >= REGISTER_LIMIT) fail("expression too complex (out of registers)");
+        maxRegister = std::max(maxRegister, nextRegister + 1);
+        return nextRegister++;
+    }
+    void freeRegister(int reg) { nextRegister = reg; }
+
+    // ── байткод ──
+    size_t emit(OpCode op, int a = 0, int b = 0, int c = 0) {
+        out->push_back({ op, uint8_t(a), uint8_t(b), uint8_t(c) });
+        return out->size() - 1;
+    }
+    size_t emitWide(OpCode op, int a, int bx) {
+        return emit(op, a, bx & 0xFF, (bx >> 8) & 0xFF);
+    }
+    void patchJump(size_t at, size_t target) {
+        long offset = long(target) - long(at + 1);
+        if (offset < INT16_MIN || offset > INT16_MAX) fail("script too long (jump out of range)");
+        uint16_t bx = uint16_t(int16_t(offset));
+        (*out)[at].b = uint8_t(bx & 0xFF);
+        (*out)[at].c = uint8_t(bx >> 8);
+    }
+    int constant(float value) {
+        for (size_t i = 0; i < constants.size(); ++i)
+            if (constants[i] == value) return int(i);
+        if (constants.size() > UINT16_MAX) fail("too many constants");
+        constants.push_back(value);
+        return int(constants.size() - 1);
+    }
+
+    const Local* findLocal(const std::string& name) const {
+        for (size_t i = locals.size(); i-- > 0;)
+            if (locals[i].name == name) return &locals[i];
+        return nullptr;
+    }
+    int binding(const std::string& name) {
+        int slot = bindings.resolve(name);
+        if (slot < 0) fail("unknown name '" + name + "'");
+        if (slot > UINT16_MAX) fail("too many bindings");
+        return slot;
+    }
+
+    // ── операторы ──
+    void statement() {
+        if (isKeyword("var") || isKeyword("let")) return declaration();
+        if (isKeyword("if")) return ifStatement();
+        if (isKeyword("while")) return whileStatement();
+        if (peek().type == TokenType::Name) return assignment();
+        fail("expected statement");
+    }
+
+    void block() {
+        expect("{");
+        size_t localMark = locals.size();
+        int registerMark = nextRegister;
+        while (!isSymbol("}")) {
+            if (peek().type == TokenType::End) fail("expected '}'");
+            statement();
+        }
+        ++pos;
+        locals.resize(localMark);
+        nextRegister = registerMark;
+    }
+
+    void declaration() {
+        bool persistent = next().text == "var";
+        if (persistent && depth > 0) fail("'var' is only allowed at the top level");
+        if (peek().type != TokenType::Name) fail("expected variable name");
+        std::string name = next().text;
+        if (name.find('.') != std::string::npos || name == "dt" || name == "time" || isReserved(name))
+            fail("bad variable name '" + name + "'");
+        expect("=");
+
+        if (persistent) {
+            // 🔹 Инициализатор var — в отдельный кусок кода, который выполнится один раз
+            int reg = nextPersistent++;
+            out = &init;
+            expression(reg);
+            out = &code;
+            locals.push_back({ name, reg, persistent });
+            return;
+        }
+        int reg = allocRegister();
+        expression(reg);
+        locals.push_back({ name, reg, persistent });
+    }
+
+    void assignment() {
+        const Token& target = next();
+        std::string op = peek().type == TokenType::Symbol ? peek().text : "";
+        OpCode arith;
+        if (op == "=") arith = OpCode::Move;
+        else if (op == "+=") arith = OpCode::Add;
+        else if (op == "-=") arith = OpCode::Sub;
+        else if (op == "*=") arith = OpCode::Mul;
+        else if (op == "/=") arith = OpCode::Div;
+        else fail("expected '=' after '" + target.text + "'");
+        ++pos;
+
+        if (target.text == "dt" || target.text == "time") fail("'" + target.text + "' is read-only");
+
+        if (const Local* local = findLocal(target.text)) {
+            // 🔹 Правая часть — во временный регистр: она может читать саму переменную (a = b + a)
+            int reg = local->reg;
+            int value = allocRegister();
+            expression(value);
+            if (arith == OpCode::Move) emit(OpCode::Move, reg, value);
+            else emit(arith, reg, reg, value);
+            freeRegister(value);
+            return;
+        }
+
+        int slot = binding(target.text);
+        int value = allocRegister();
+        if (arith == OpCode::Move) {
+            expression(value);
+        } else {
+            int rhs = allocRegister();
+            emitWide(OpCode::LoadB, value, slot);
+            expression(rhs);
+            emit(arith, value, value, rhs);
+            freeRegister(rhs);
+        }
+        emitWide(OpCode::StoreB, value, slot);
+        freeRegister(value);
+    }
+
+    void ifStatement() {
+        ++pos;
+        size_t skipThen = condition();
+        ++depth;
+        block();
+        --depth;
+
+        if (isKeyword("else")) {
+            ++pos;
+            size_t skipElse = emit(OpCode::Jump);
+            patchJump(skipThen, out->size());
+            if (isKeyword("if")) {
+                ifStatement();
+            } else {
+                ++depth;
+                block();
+                --depth;
+            }
+            patchJump(skipElse, out->size());
+        } else {
+            patchJump(skipThen, out->size());
+        }
+    }
+
+    void whileStatement() {
+        ++pos;
+        size_t loopStart = out->size();
+        size_t exit = condition();
+        ++depth;
+        block();
+        --depth;
+        size_t back = emit(OpCode::Jump);
+        patchJump(back, loopStart);
+        patchJump(exit, out->size());
+    }
+
+    // 🔹 Условие → JumpIfFalse с пока пустым смещением
+    size_t condition() {
+        int reg = allocRegister();
+        expression(reg);
+        freeRegister(reg);
+        return emit(OpCode::JumpIfFalse, reg);
+    }
+
+    // ── выражения: результат всегда в регистре dest ──
+    void expression(int dest) { orExpression(dest); }
+
+    void binary(int dest, OpCode op, void (ScriptCompiler::*operand)(int), bool swap = false) {
+        int rhs = allocRegister();
+        (this->*operand)(rhs);
+        if (swap) emit(op, dest, rhs, dest);
+        else emit(op, dest, dest, rhs);
+        freeRegister(rhs);
+    }
+
+    void orExpression(int dest) {
+        andExpression(dest);
+        while (isKeyword("or")) { ++pos; binary(dest, OpCode::Or, &ScriptCompiler::andExpression); }
+    }
+    void andExpression(int dest) {
+        comparison(dest);
+        while (isKeyword("and")) { ++pos; binary(dest, OpCode::And, &ScriptCompiler::comparison); }
+    }
+    void comparison(int dest) {
+        additive(dest);
+        if (accept("<")) binary(dest, OpCode::Lt, &ScriptCompiler::additive);
+        else if (accept("<=")) binary(dest, OpCode::Le, &ScriptCompiler::additive);
+        else if (accept(">")) binary(dest, OpCode::Lt, &ScriptCompiler::additive, true);
+        else if (accept(">=")) binary(dest, OpCode::Le, &ScriptCompiler::additive, true);
+        else if (accept("==")) binary(dest, OpCode::Eq, &ScriptCompiler::additive);
+        else if (accept("!=")) binary(dest, OpCode::Ne, &ScriptCompiler::additive);
+    }
+    void additive(int dest) {
+        multiplicative(dest);
+        while (true) {
+            if (accept("+")) binary(dest, OpCode::Add, &ScriptCompiler::multiplicative);
+            else if (accept("-")) binary(dest, OpCode::Sub, &ScriptCompiler::multiplicative);
+            else break;
+        }
+    }
+    void multiplicative(int dest) {
+        unary(dest);
+        while (true) {
+            if (accept("*")) binary(dest, OpCode::Mul, &ScriptCompiler::unary);
+            else if (accept("/")) binary(dest, OpCode::Div, &ScriptCompiler::unary);
+            else if (accept("%")) binary(dest, OpCode::Mod, &ScriptCompiler::unary);
+            else break;
+        }
+    }
+    void unary(int dest) {
+        if (accept("-")) {
+            unary(dest);
+            emit(OpCode::Neg, dest, dest);
+        } else if (isKeyword("not")) {
+            ++pos;
+            unary(dest);
+            emit(OpCode::Not, dest, dest);
+        } else {
+            primary(dest);
+        }
+    }
+
+    void primary(int dest) {
+        const Token& token = peek();
+        if (token.type == TokenType::Number) {
+            ++pos;
+            emitWide(OpCode::LoadK, dest, constant(token.number));
+            return;
+        }
+        if (accept("(")) {
+            expression(dest);
+            expect(")");
+            return;
+        }
+        if (token.type != TokenType::Name || isReserved(token.text)) fail("expected expression");
+        ++pos;
+
+        if (isSymbol("(")) return call(dest, token.text);
+
+        if (token.text == "dt") { emit(OpCode::Move, dest, REGISTER_DT); return; }
+        if (token.text == "time") { emit(OpCode::Move, dest, REGISTER_TIME); return; }
+        if (const Local* local = findLocal(token.text)) {
+            // ⚠️ init выполняется раньше тела кадра — значения let там ещё нет
+            if (out == &init && !local->persistent)
+                fail("'" + token.text + "' is a 'let' variable and cannot be used in a 'var' initializer");
+            if (local->reg != dest) emit(OpCode::Move, dest, local->reg);
+            return;
+        }
+        emitWide(OpCode::LoadB, dest, binding(token.text));
+    }
+
+    void call(int dest, const std::string& name) {
+        int fn = 0;
+        while (fn < BUILTIN_COUNT && name != BUILTINS[fn].name) ++fn;
+        if (fn == BUILTIN_COUNT) fail("unknown function '" + name + "'");
+
+        // 🔹 Аргументы — в подряд идущие временные регистры
+        expect("(");
+        int base = nextRegister;
+        for (int i = 0; i < BUILTINS[fn].arity; ++i) {
+            if (i > 0) expect(",");
+            expression(allocRegister());
+        }
+        expect(")");
+        emit(OpCode::Call, dest, fn, base);
+        freeRegister(base);
+    }
+
+    static bool isReserved(const std::string& name) {
+        static const char* words[] = { "var", "let", "if", "else", "while", "and", "or", "not" };
+        for (const char* w : words)
+            if (name == w) return true;
+        return false;
+    }
+
+    const std::vector<Token>& tokens;
+    size_t pos = 0;
+    ScriptBindings& bindings;
+    std::vector<Instruction>& init;
+    std::vector<Instruction>& code;
+    std::vector<float>& constants;
+    std::vector<Instruction>* out;
+
+    std::vector<Local> locals;
+    int nextRegister = REGISTER_TIME + 1;
+    int nextPersistent = REGISTER_TIME + 1; // следующий свободный регистр var
+    int maxRegister = REGISTER_TIME + 1;
+    int depth = 0;
+};
+
+} // namespace
+
+bool compileScript(const std::string& source, ScriptBindings& bindings, Script& script, ScriptError& error) {
+    std::vector<Instruction> init, code;
+    std::vector<float> constants;
+    int registers = 0;
+    try {
+        std::vector<Token> tokens = tokenize(source);
+        ScriptCompiler compiler(tokens, bindings, init, code, constants);
+        registers = compiler.compile();
+    } catch (const CompileFailure& failure) {
+        error.line = failure.line;
+        error.message = failure.message;
+        return false;
+    }
+
+    script.init = std::move(init);
+    script.code = std::move(code);
+    script.constants = std::move(constants);
+    script.registers.assign(size_t(registers), 0.0f);
+    script.bindings = &bindings;
+    script.initialized = false;
+    return true;
+}
+
+bool loadScriptFile(const std::string& path, ScriptBindings& bindings, Script& script, ScriptError& error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error.line = 0;
+        error.message = "cannot open file";
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    script.name = path;
+    return compileScript(buffer.str(), bindings, script, error);
+}
+
+// ───── Интерпретатор ─────
+
+bool Script::run(float deltaTime, float time) {
+    registers[REGISTER_DT] = deltaTime;
+    registers[REGISTER_TIME] = time;
+
+    uint32_t remaining = budget;
+    bool finished = true;
+    if (!initialized) {
+        // 🔹 Прерванный бюджетом init повторится целиком в следующем кадре
+        finished = execute(init, remaining);
+        initialized = finished;
+    }
+    if (finished) finished = execute(code, remaining);
+
+    executed = budget - remaining;
+    if (!finished) ++overBudgetCount;
+    return finished;
+}
+
+bool Script::execute(const std::vector<Instruction>& program, uint32_t& remaining) {
+    float* r = registers.data();
+    const float* k = constants.data();
+    const Instruction* ins = program.data();
+    const size_t count = program.size();
+
+    size_t pc = 0;
+    while (pc < count) {
+        if (remaining == 0) return false; // ⏳ бюджет кончился — кадр не ждёт зациклившийся сценарий
+        --remaining;
+
+        const Instruction& i = ins[pc++];
+        switch (i.op) {
+            case OpCode::LoadK:  r[i.a] = k[i.bx()]; break;
+            case OpCode::Move:   r[i.a] = r[i.b]; break;
+            case OpCode::LoadB:  r[i.a] = bindings->get(i.bx()); break;
+            case OpCode::StoreB: bindings->set(i.bx(), r[i.a]); break;
+
+            case OpCode::Add: r[i.a] = r[i.b] + r[i.c]; break;
+            case OpCode::Sub: r[i.a] = r[i.b] - r[i.c]; break;
+            case OpCode::Mul: r[i.a] = r[i.b] * r[i.c]; break;
+            case OpCode::Div: r[i.a] = r[i.b] / r[i.c]; break;
+            case OpCode::Mod: r[i.a] = std::fmod(r[i.b], r[i.c]); break;
+
+            case OpCode::Lt:  r[i.a] = r[i.b] < r[i.c] ? 1.0f : 0.0f; break;
+            case OpCode::Le:  r[i.a] = r[i.b] <= r[i.c] ? 1.0f : 0.0f; break;
+            case OpCode::Eq:  r[i.a] = r[i.b] == r[i.c] ? 1.0f : 0.0f; break;
+            case OpCode::Ne:  r[i.a] = r[i.b] != r[i.c] ? 1.0f : 0.0f; break;
+            case OpCode::And: r[i.a] = (r[i.b] != 0.0f && r[i.c] != 0.0f) ? 1.0f : 0.0f; break;
+            case OpCode::Or:  r[i.a] = (r[i.b] != 0.0f || r[i.c] != 0.0f) ? 1.0f : 0.0f; break;
+
+            case OpCode::Neg: r[i.a] = -r[i.b]; break;
+            case OpCode::Not: r[i.a] = r[i.b] == 0.0f ? 1.0f : 0.0f; break;
+
+            case OpCode::Call: {
+                const float* arg = r + i.c;
+                float v = 0.0f;
+                switch (i.b) {
+                    case BUILTIN_SIN:   v = std::sin(arg[0]); break;
+                    case BUILTIN_COS:   v = std::cos(arg[0]); break;
+                    case BUILTIN_SQRT:  v = std::sqrt(arg[0]); break;
+                    case BUILTIN_ABS:   v = std::fabs(arg[0]); break;
+                    case BUILTIN_FLOOR: v = std::floor(arg[0]); break;
+                    case BUILTIN_MIN:   v = std::min(arg[0], arg[1]); break;
+                    case BUILTIN_MAX:   v = std::max(arg[0], arg[1]); break;
+                    case BUILTIN_CLAMP: v = std::min(std::max(arg[0], arg[1]), arg[2]); break;
+                    case BUILTIN_LERP:  v = arg[0] + (arg[1] - arg[0]) * arg[2]; break;
+                }
+                r[i.a] = v;
+                break;
+            }
+
+            case OpCode::Jump:
+                pc = size_t(long(pc) + i.sbx());
+                break;
+            case OpCode::JumpIfFalse:
+                if (r[i.a] == 0.0f) pc = size_t(long(pc) + i.sbx());
+                break;
+        }
+    }
+    return true;
+}
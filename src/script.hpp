@@ -0,0 +1,119 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "animation.hpp"
+
+struct Transform;
+
+// 📜 Сценарии сцены: маленький язык → компактный байткод → регистровая машина.
+//
+//   # комментарий до конца строки
+//   var angle = 0              # 🔹 var — живёт между кадрами, инициализируется один раз
+//   angle += 45 * dt           # dt — секунды с прошлого кадра, time — с начала работы
+//   cam.horizontalAngle = angle
+//   let r = 300                # 🔹 let — локальная переменная блока, заново каждый кадр
+//   model.x = r * sin(time)
+//   if cam.y < 0 { cam.y = 0 } else if cam.y > 500 { cam.y = 500 }
+//   while r > 100 { r -= 50 }
+//
+// Выражения: + - * / %, < <= > >= == !=, and or not, скобки,
+// функции sin cos sqrt abs floor min max clamp lerp.
+// Имена через точку (cam.x, model.scale, door.open) — привязки к полям движка (ScriptBindings).
+
+// ⚙️ Код операции: 4 байта на инструкцию — op, a и либо b, c, либо 16-битный bx = b | c << 8
+enum class OpCode : uint8_t {
+    LoadK,   // r[a] = constants[bx]
+    Move,    // r[a] = r[b]
+    LoadB,   // r[a] = привязка bx
+    StoreB,  // привязка bx = r[a]
+    Add, Sub, Mul, Div, Mod,  // r[a] = r[b] ∘ r[c]
+    Lt, Le, Eq, Ne, And, Or,  // r[a] = (r[b] ∘ r[c]) ? 1 : 0
+    Neg, Not,                 // r[a] = ∘ r[b]
+    Call,    // r[a] = builtin b (аргументы — r[c], r[c + 1], ...)
+    Jump,    // pc += sbx
+    JumpIfFalse, // if r[a] == 0: pc += sbx
+};
+
+struct Instruction {
+    OpCode op;
+    uint8_t a, b, c;
+
+    uint16_t bx() const { return uint16_t(b | (c << 8)); }
+    int16_t sbx() const { return int16_t(bx()); }
+};
+
+// 🔗 Что видно сценарию: имя → float движка. Привязки создаются при загрузке,
+// в байткоде остаётся только номер привязки.
+class ScriptBindings {
+public:
+    void bind(const std::string& name, float* value);                      // 🔹 cam.x → &cam.x
+    void bindTransform(const std::string& prefix, Transform& transform);   // 🧭 model.x/y/z/rotationY/scale
+    void bindAnimation(const std::string& prefix, AnimationSystem& animations, uint32_t object); // 🎬 door.<параметр>
+
+    // 🔎 Номер привязки по имени или -1. Параметры анимации интернируются здесь же (только при загрузке)
+    int resolve(const std::string& name);
+
+    float get(uint32_t slot) const {
+        const Slot& s = slots[slot];
+        return s.value ? *s.value : s.animations->value(s.object, s.param);
+    }
+    void set(uint32_t slot, float v) const {
+        const Slot& s = slots[slot];
+        if (s.value) *s.value = v;
+        else s.animations->setValue(s.object, s.param, v);
+    }
+
+private:
+    struct Slot {
+        std::string name;
+        float* value = nullptr;                 // прямая привязка
+        AnimationSystem* animations = nullptr;  // или параметр объекта анимации
+        uint32_t object = 0;
+        ParamId param = INVALID_PARAM;
+    };
+    struct AnimationPrefix { std::string prefix; AnimationSystem* animations; uint32_t object; };
+
+    std::vector<Slot> slots;
+    std::vector<AnimationPrefix> animationPrefixes;
+};
+
+struct ScriptError {
+    int line = 0; // 📍 строка исходника
+    std::string message;
+};
+
+const uint32_t SCRIPT_DEFAULT_BUDGET = 100000; // ⏳ инструкций на один запуск
+
+// 🧠 Скомпилированный сценарий со своими регистрами. run() ничего не выделяет:
+// регистры, константы и код подготовлены при компиляции.
+class Script {
+public:
+    std::string name;
+    uint32_t budget = SCRIPT_DEFAULT_BUDGET;
+    uint32_t overBudgetCount = 0; // сколько кадров сценарий не уложился в бюджет
+
+    // ▶️ Один кадр. false — кончился бюджет инструкций (сценарий прерван до конца кадра)
+    bool run(float deltaTime, float time);
+
+    size_t codeSize() const { return code.size(); }
+    uint32_t lastInstructionCount() const { return executed; }
+
+private:
+    friend bool compileScript(const std::string& source, ScriptBindings& bindings, Script& script, ScriptError& error);
+
+    bool execute(const std::vector<Instruction>& program, uint32_t& remaining);
+
+    std::vector<Instruction> init;  // var-инициализаторы — один раз перед первым кадром
+    std::vector<Instruction> code;  // тело кадра
+    std::vector<float> constants;
+    std::vector<float> registers;   // r0 = dt, r1 = time, дальше переменные и временные
+    const ScriptBindings* bindings = nullptr;
+    bool initialized = false;
+    uint32_t executed = 0;
+};
+
+bool compileScript(const std::string& source, ScriptBindings& bindings, Script& script, ScriptError& error);
+bool loadScriptFile(const std::string& path, ScriptBindings& bindings, Script& script, ScriptError& error);
@@ -0,0 +1,143 @@
+// thread_pool.cpp
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+// 🔹 Кто мы: рабочий какого пула (задачи из задач идут в свою очередь — без борьбы за чужие)
+static thread_local const ThreadPool* currentPool = nullptr;
+static thread_local size_t currentWorker = 0;
+
+ThreadPool::ThreadPool(unsigned threadCount) {
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    // 🔹 Один поток — вызывающий, остальные — рабочие
+    for (unsigned i = 1; i < threadCount; ++i)
+        queues.push_back(std::make_unique<WorkQueue>());
+    for (size_t i = 0; i < queues.size(); ++i)
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+void ThreadPool::runIndices() {
+    for (size_t i = nextIndex.fetch_add(1, std::memory_order_relaxed); i < jobCount;
+         i = nextIndex.fetch_add(1, std::memory_order_relaxed))
+        (*job)(i);
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+    if (count == 0) return;
+    if (workers.empty() || count == 1) {
+        for (size_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> call(callMutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &fn;
+        jobCount = count;
+        nextIndex.store(0, std::memory_order_relaxed);
+        ++generation;
+    }
+    wake.notify_all();
+
+    runIndices(); // 🔹 вызывающий поток не простаивает
+
+    // ⏳ Новых не пускаем и ждём только тех, кто успел войти — после этого fn можно уничтожать
+    std::unique_lock<std::mutex> lock(mutex);
+    job = nullptr;
+    done.wait(lock, [&] { return busyWorkers == 0; });
+}
+
+void ThreadPool::submit(Task task) {
+    if (workers.empty()) {
+        task();
+        return;
+    }
+
+    // 🔹 Счётчик — до очереди: иначе рабочий успеет взять задачу и уменьшить его раньше, чем он вырос
+    // (size_t перевалит через ноль). Рабочий, увидевший счётчик чуть раньше задачи, просто проверит ещё раз
+    pendingTasks.fetch_add(1, std::memory_order_release);
+    size_t target = currentPool == this ? currentWorker : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+
+    // 🔔 Через mutex: рабочий либо ещё не проверил pendingTasks, либо уже ждёт — сигнал не потеряется
+    { std::lock_guard<std::mutex> lock(mutex); }
+    wake.notify_one();
+}
+
+bool ThreadPool::popTask(size_t self, Task& out) {
+    // 🔹 Своя очередь — с конца
+    {
+        WorkQueue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            out = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            pendingTasks.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    // 🦝 Кража — с начала чужих, начиная с соседа
+    for (size_t k = 1; k < queues.size(); ++k) {
+        WorkQueue& other = *queues[(self + k) % queues.size()];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if (!other.tasks.empty()) {
+            out = std::move(other.tasks.front());
+            other.tasks.pop_front();
+            pendingTasks.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t self) {
+    currentPool = this;
+    currentWorker = self;
+
+    uint64_t seen = 0;
+    while (true) {
+        bool joinJob = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] {
+                return stopping || (job && generation != seen) || pendingTasks.load(std::memory_order_acquire) > 0;
+            });
+            if (stopping) return;
+            if (job && generation != seen) {
+                seen = generation;
+                ++busyWorkers;
+                joinJob = true;
+            }
+        }
+
+        if (joinJob) {
+            runIndices();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busyWorkers == 0) done.notify_one();
+            continue;
+        }
+
+        Task task;
+        if (popTask(self, task)) task();
+    }
+}
+
+ThreadPool& threadPool() {
+    static ThreadPool pool;
+    return pool;
+}
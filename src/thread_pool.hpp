@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 🧵 Пул рабочих потоков движка: параллельные стадии кадра (parallelFor) и фоновые задачи (submit).
+// parallelFor раздаёт индексы через атомарный счётчик; вызывающий поток тоже работает.
+// Задачи лежат в очередях рабочих: свою очередь поток берёт с конца (свежее — горячее в кэше),
+// а опустев — крадёт с начала чужой. Стадии кадра важнее: свободный рабочий сначала идёт в parallelFor.
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(unsigned threadCount = 0); // 0 — по числу ядер
+    ~ThreadPool(); // ⚠️ невыполненные задачи отбрасываются
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return unsigned(workers.size()) + 1; } // + вызывающий поток
+
+    // 🔁 fn(i) для всех i из [0, count); возвращается, когда всё сделано.
+    // Рабочие, занятые долгими задачами, в нём не участвуют — и не задерживают его.
+    // ⚠️ Вызовы из разных потоков выполняются по очереди; изнутри fn вызывать нельзя
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+    // 📨 Фоновая задача. Из задачи пула — в очередь этого же рабочего, иначе — по очередям по кругу.
+    // Без рабочих потоков (одно ядро) выполняется сразу на вызывающем.
+    // ⚠️ Задача не должна ждать другие задачи пула: все рабочие могут оказаться заняты ожиданием
+    void submit(Task task);
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(size_t self);
+    void runIndices();
+    bool popTask(size_t self, Task& out);
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkQueue>> queues; // по одной на рабочего
+    std::atomic<size_t> pendingTasks{ 0 };
+    std::atomic<size_t> nextQueue{ 0 };
+
+    std::mutex callMutex; // одно parallelFor за раз
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    // текущее parallelFor
+    const std::function<void(size_t)>* job = nullptr;
+    size_t jobCount = 0;
+    std::atomic<size_t> nextIndex{ 0 };
+    size_t busyWorkers = 0; // рабочих внутри текущего parallelFor
+    uint64_t generation = 0;
+    bool stopping = false;
+};
+
+ThreadPool& threadPool(); // 🔹 общий пул движка (создаётся при первом обращении)
@@ -0,0 +1,111 @@
+#include <cstdio>
+#include <fstream>
+
+#include "animation.hpp"
+#include "scene.hpp"
+#include "script.hpp"
+#include "test.hpp"
+
+// 🎬 Анимации: клипы манифеста, объекты и положение экземпляров
+
+namespace {
+
+const char* MANIFEST = R"({
+  "animations": [
+    { "name": "spin", "keys": [ { "time": 0, "rotationY": 0 }, { "time": 4, "rotationY": 360 } ] },
+    { "name": "rise", "loop": false, "keys": [ { "time": 0, "y": 0, "open": 0 }, { "time": 1, "y": 100, "open": 1 } ] }
+  ],
+  "models": [
+    { "path": "a.json", "x": 10, "scale": 2, "animation": "spin" },
+    { "path": "b.json", "x": 50, "name": "door", "animation": "rise", "animationSpeed": 0.5 },
+    { "path": "c.json", "z": 30 }
+  ]
+})";
+
+bool readManifest(const std::string& text, std::vector<SceneEntry>& entries, std::vector<SceneClip>& clips,
+                  std::string& error) {
+    std::string path = std::string(P_tmpdir) + "/engine_tests_scene.json";
+    std::ofstream(path) << text;
+    bool ok = readSceneManifest(path, entries, clips, error);
+    std::remove(path.c_str());
+    return ok;
+}
+
+} // namespace
+
+TEST(animation, manifest_drives_instances) {
+    std::vector<SceneEntry> entries;
+    std::vector<SceneClip> clips;
+    std::string error;
+    CHECK(readManifest(MANIFEST, entries, clips, error));
+    CHECK(entries.size() == 3 && clips.size() == 2);
+    if (entries.size() != 3) return;
+    CHECK(entries[1].name == "door" && entries[1].animation == "rise");
+
+    Scene scene;
+    for (const SceneEntry& entry : entries) scene.add(nullptr, entry.transform, entry.tint);
+    AnimationSystem animations;
+    ScriptBindings bindings;
+    scene.bindAnimations(0, entries, clips, animations, &bindings);
+    CHECK(animations.clipCount() == 2);
+    CHECK(scene.animated.size() == 2);
+
+    // ⏱️ Секунда: spin — четверть оборота, rise на половинной скорости — половина подъёма
+    animations.update(1.0f);
+    scene.applyAnimations(animations);
+    const Transform& spin = scene.instances[0].transform;
+    CHECK_NEAR(spin.rotationY, 90.0f, 1e-3f);
+    CHECK_NEAR(spin.x, 10.0f, 0.0f);    // 🔹 параметры без дорожки остаются из манифеста
+    CHECK_NEAR(spin.scale, 2.0f, 0.0f);
+    const Transform& door = scene.instances[1].transform;
+    CHECK_NEAR(door.y, 50.0f, 1e-3f);
+    CHECK_NEAR(door.x, 50.0f, 0.0f);
+    CHECK_NEAR(scene.instances[2].transform.z, 30.0f, 0.0f);
+
+    // 📜 Сценарий видит экземпляр по имени: и параметры положения, и собственные параметры клипа
+    Script script;
+    ScriptError scriptError;
+    CHECK(compileScript("door.x = door.open * 1000 door.scale = 3", bindings, script, scriptError));
+    script.run(0.0f, 0.0f);
+    animations.update(0.0f);
+    scene.applyAnimations(animations);
+    CHECK_NEAR(door.x, 500.0f, 1e-2f);
+    CHECK_NEAR(door.scale, 3.0f, 0.0f);
+
+    // 🔹 Клип без повтора упирается в конец
+    animations.update(10.0f);
+    scene.applyAnimations(animations);
+    CHECK_NEAR(door.y, 100.0f, 1e-3f);
+}
+
+TEST(animation, manifest_errors) {
+    std::vector<SceneEntry> entries;
+    std::vector<SceneClip> clips;
+    std::string error;
+    CHECK(!readManifest(R"({ "models": [ { "path": "a.json", "animation": "missing" } ] })", entries, clips, error));
+    CHECK(error.find("missing") != std::string::npos);
+    CHECK(!readManifest(R"({ "animations": [ { "name": "a", "keys": [ { "x": 1 } ] } ], "models": [] })",
+                        entries, clips, error));
+    CHECK(!readManifest(R"({ "animations": [ { "name": "a", "keys": [ { "time": 0, "x": "far" } ] } ], "models": [] })",
+                        entries, clips, error));
+}
+
+TEST(animation, values_bounds_checked) {
+    AnimationSystem animations;
+    uint32_t object = animations.addObject();
+    ParamId known = animations.params.intern("open");
+    animations.refreshParams();
+    animations.setValue(object, known, 0.5f);
+
+    // ⚠️ Интернирован без refreshParams — строка таблицы ещё узкая
+    ParamId late = animations.params.intern("late");
+    animations.setValue(object, late, 7.0f);
+    CHECK_NEAR(animations.value(object, late), 0.0f, 0.0f);
+    CHECK_NEAR(animations.value(object + 1, known), 0.0f, 0.0f);
+    CHECK_NEAR(animations.value(object, known), 0.5f, 0.0f);
+
+    animations.refreshParams();
+    animations.setValue(object, late, 7.0f);
+    CHECK_NEAR(animations.value(object, late), 7.0f, 0.0f);
+    CHECK_NEAR(animations.value(object, known), 0.5f, 0.0f);
+}
@@ -0,0 +1,106 @@
+#include <memory>
+
+#include "bvh.hpp"
+#include "core.hpp"
+#include "damage.hpp"
+#include "mesh.hpp"
+#include "scene.hpp"
+#include "test.hpp"
+
+// 🩹 Частичная перерисовка должна давать тот же кадр, что и полная
+
+namespace {
+
+// 🔹 Куб со стороной size: 6 граней разного цвета, каждая — замкнутая линия из 4 отрезков
+std::shared_ptr<const Mesh> makeCube(float size) {
+    static const int faces[6][4][3] = {
+        { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 } }, { { 0, 0, 1 }, { 0, 1, 1 }, { 1, 1, 1 }, { 1, 0, 1 } },
+        { { 0, 0, 0 }, { 0, 1, 0 }, { 0, 1, 1 }, { 0, 0, 1 } }, { { 1, 0, 0 }, { 1, 0, 1 }, { 1, 1, 1 }, { 1, 1, 0 } },
+        { { 0, 0, 0 }, { 0, 0, 1 }, { 1, 0, 1 }, { 1, 0, 0 } }, { { 0, 1, 0 }, { 1, 1, 0 }, { 1, 1, 1 }, { 0, 1, 1 } },
+    };
+    auto mesh = std::make_shared<Mesh>();
+    for (int f = 0; f < 6; ++f) {
+        uint8_t r = uint8_t(60 + 30 * f), g = uint8_t(220 - 30 * f), b = uint8_t(40 * f);
+        for (int i = 0; i < 4; ++i) {
+            for (int end = 0; end < 2; ++end) {
+                const int* c = faces[f][(i + end) % 4];
+                mesh->addPoint({ c[0] * size, c[1] * size, c[2] * size, r, g, b, 1.0f, 1.0f });
+            }
+            mesh->endLine();
+        }
+        mesh->endPolygon(0.5f, 0.0f, "", "");
+    }
+    buildMeshBounds(*mesh);
+    return mesh;
+}
+
+// 🎬 Кадр как в main.cpp: трекер решает, что перерисовать; false — кадр не изменился
+bool renderFrame(const Scene& scene, DamageTracker& tracker, FrameDamage& damage) {
+    app.beginFrame(cam);
+    if (!tracker.update(app.view, windowWidth, windowHeight, app.raster.tileSize(), scene, nullptr, false, damage))
+        return false;
+    app.clear(app.frame, &damage);
+    app.drawScene(scene, nullptr, &damage);
+    app.endFrame(app.frame, &damage);
+    return true;
+}
+
+// 🖼️ Тот же кадр с нуля, без трекера
+std::vector<uint32_t> renderReference(const Scene& scene) {
+    Framebuffer saved = app.frame;
+    app.beginFrame(cam);
+    app.frame.resize(1, 1); // 🔹 другой размер — clear() перезаполняет весь буфер
+    app.clear(app.frame);
+    app.drawScene(scene);
+    app.endFrame(app.frame);
+    std::vector<uint32_t> color = app.frame.color;
+    app.frame = saved;
+    return color;
+}
+
+} // namespace
+
+TEST(damage, partial_redraw_matches_full) {
+    windowWidth = 640;
+    windowHeight = 480;
+    app.setDPI(96);
+    app.raster.settings.filled = true;
+    cam = Camera();
+
+    std::shared_ptr<const Mesh> cube = makeCube(40.0f);
+    Scene scene;
+    for (int i = 0; i < 3; ++i) {
+        Transform transform;
+        transform.x = -150.0f + 130.0f * i;
+        transform.z = 400.0f;
+        scene.add(cube, transform);
+    }
+
+    DamageTracker tracker;
+    FrameDamage damage;
+    CHECK(renderFrame(scene, tracker, damage));
+    CHECK(damage.full);
+    CHECK(!renderFrame(scene, tracker, damage)); // 💤 ничего не изменилось
+
+    // 🔹 Сдвинули и повернули один экземпляр — перерисовываются только его старое и новое места
+    scene.instances[1].transform.x += 25.0f;
+    scene.instances[1].transform.rotationY = 30.0f;
+    CHECK(renderFrame(scene, tracker, damage));
+    CHECK(!damage.full && !damage.rects.empty());
+    CHECK(app.frame.color == renderReference(scene));
+
+    // 🔹 Оттенок тоже портит место экземпляра
+    scene.instances[2].tint = 0x80FF80;
+    CHECK(renderFrame(scene, tracker, damage));
+    CHECK(!damage.full);
+    CHECK(app.frame.color == renderReference(scene));
+
+    // 🔍 Масштаб (и фокусное расстояние) меняет матрицу кадра при той же камере — кадр целиком
+    float scale = app.scale;
+    app.scale = scale * 1.25f;
+    CHECK(renderFrame(scene, tracker, damage));
+    CHECK(damage.full);
+    CHECK(app.frame.color == renderReference(scene));
+    app.scale = scale;
+    app.raster.settings.filled = false;
+}
@@ -0,0 +1,39 @@
+#include <cstring>
+
+#include "core.hpp"
+#include "test.hpp"
+
+App app; // 🔹 движок ждёт глобальное приложение (как main.cpp и бенчмарки)
+
+static int failures = 0;
+
+std::vector<TestCase>& testCases() {
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+void reportFailure(const char* file, int line, const std::string& message) {
+    std::fprintf(stderr, "  ❌ %s:%d: %s\n", file, line, message.c_str());
+    ++failures;
+}
+
+// ▶️ engine-tests [группа] — без аргумента прогоняются все группы
+int main(int argc, char** argv) {
+    const char* group = argc > 1 ? argv[1] : nullptr;
+    int ran = 0, failed = 0;
+    for (const TestCase& test : testCases()) {
+        if (group && std::strcmp(group, test.group) != 0) continue;
+        int before = failures;
+        test.body();
+        ++ran;
+        bool ok = failures == before;
+        if (!ok) ++failed;
+        std::printf("%s %s.%s\n", ok ? "✅" : "❌", test.group, test.name);
+    }
+    if (ran == 0) {
+        std::fprintf(stderr, "Нет тестов в группе %s\n", group ? group : "(все)");
+        return 1;
+    }
+    std::printf("%d of %d passed\n", ran - failed, ran);
+    return failed ? 1 : 0;
+}
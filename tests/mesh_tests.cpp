@@ -0,0 +1,170 @@
+#include <cstdio>
+#include <fstream>
+
+#include "bvh.hpp"
+#include "material.hpp"
+#include "mesh.hpp"
+#include "mesh_cache.hpp"
+#include "test.hpp"
+
+// 📦 Модель и её бинарный кэш
+
+namespace {
+
+// 🔹 Сетка квадратов size × size на плоскости y = 0
+Mesh makeGrid(int size) {
+    Mesh mesh;
+    mesh.modelName = "grid";
+    for (int row = 0; row < size; ++row) {
+        for (int col = 0; col < size; ++col) {
+            float x = col * 10.0f, z = row * 10.0f;
+            const float corners[4][2] = { { x, z }, { x + 10, z }, { x + 10, z + 10 }, { x, z + 10 } };
+            for (int i = 0; i < 4; ++i) {
+                mesh.addPoint({ corners[i][0], 0.0f, corners[i][1], 200, 200, 200, 1.0f, 1.0f });
+                mesh.addPoint({ corners[(i + 1) % 4][0], 0.0f, corners[(i + 1) % 4][1], 200, 200, 200, 1.0f, 1.0f });
+                mesh.endLine();
+            }
+            mesh.endPolygon(0.5f, 0.0f, "", "");
+        }
+    }
+    buildMeshBounds(mesh);
+    return mesh;
+}
+
+std::string tempPath(const char* name) {
+    return std::string(P_tmpdir) + "/engine_tests_" + name;
+}
+
+} // namespace
+
+TEST(mesh, cached_arrays_stay_borrowed) {
+    std::string source = tempPath("grid.json");
+    std::string cache = meshCachePath(source);
+    std::ofstream(source) << "{}";
+
+    Mesh built = makeGrid(4);
+    buildMeshNormals(built);
+    CHECK(writeMeshCache(cache, built, source));
+
+    Mesh mesh;
+    CHECK(readMeshCache(cache, mesh, source));
+    CHECK(mesh.x.borrowed() && mesh.roughness.borrowed());
+
+    // 🔹 Чтение через неконстантный Mesh и построение материалов не копируют отображённые массивы
+    float sum = 0.0f;
+    for (size_t i = 0; i < mesh.pointCount(); ++i) sum += mesh.x[i] + mesh.y[i] + mesh.z[i];
+    buildMeshMaterials(mesh);
+    CHECK(mesh.x.borrowed() && mesh.y.borrowed() && mesh.z.borrowed());
+    CHECK(mesh.roughness.borrowed() && mesh.metallic.borrowed() && mesh.lightIntensity.borrowed());
+    CHECK(mesh.normalX.borrowed() && mesh.normalY.borrowed() && mesh.normalZ.borrowed()); // 📐 нормали — из кэша
+    CHECK(sum > 0.0f);
+    CHECK(mesh.hasMaterials());
+    CHECK_NEAR(std::fabs(mesh.normalY[0]), 1.0f, 1e-5f);
+
+    // ✏️ Явная запись копирует массив к себе и не трогает файл
+    mesh.x.mutableData()[0] = -1.0f;
+    CHECK(!mesh.x.borrowed());
+    CHECK_NEAR(mesh.x[0], -1.0f, 0.0f);
+    Mesh again;
+    CHECK(readMeshCache(cache, again, source));
+    CHECK_NEAR(again.x[0], built.x[0], 0.0f);
+
+    // 🔹 Кэш без нормалей тоже читается — их досчитывает buildMeshMaterials
+    Mesh plain = makeGrid(2);
+    CHECK(writeMeshCache(cache, plain, source));
+    Mesh noNormals;
+    CHECK(readMeshCache(cache, noNormals, source));
+    CHECK(!noNormals.hasNormals());
+    buildMeshMaterials(noNormals);
+    CHECK(noNormals.hasNormals() && noNormals.x.borrowed());
+    CHECK_NEAR(std::fabs(noNormals.normalY[3]), 1.0f, 1e-5f);
+
+    std::remove(cache.c_str());
+    std::remove(source.c_str());
+}
+
+TEST(mesh, materials_are_shared) {
+    // 🔹 Чередуем три шероховатости: соседние полигоны разные, но материалов всего три
+    Mesh mesh = makeGrid(4);
+    float* roughness = mesh.roughness.mutableData();
+    for (size_t p = 0; p < mesh.polygonCount(); ++p) roughness[p] = 0.25f * float(p % 3);
+    roughness[5] = -0.0f; // 🔹 равен 0 — тот же материал
+    buildMeshMaterials(mesh);
+    CHECK(mesh.materials.size() == 3);
+    for (size_t p = 0; p < mesh.polygonCount(); ++p)
+        CHECK_NEAR(mesh.materials[mesh.polygonMaterial[p]].roughness, p == 5 ? 0.0f : 0.25f * float(p % 3), 0.0f);
+}
+
+TEST(mesh, cache_rejects_broken_offsets) {
+    std::string source = tempPath("offsets.json");
+    std::string cache = meshCachePath(source);
+    std::ofstream(source) << "{}";
+
+    Mesh good = makeGrid(2);
+    CHECK(writeMeshCache(cache, good, source));
+    Mesh mesh;
+    CHECK(readMeshCache(cache, mesh, source));
+
+    // ⚠️ Концы сходятся со счётчиками, но середина битая — такой кэш читать нельзя
+    auto rejected = [&](Mesh tampered) {
+        Mesh loaded;
+        return writeMeshCache(cache, tampered, source) && !readMeshCache(cache, loaded, source);
+    };
+    Mesh tampered = good;
+    tampered.lineStart.mutableData()[1] = uint32_t(good.pointCount() + 100); // 🔹 линия за концом точек
+    CHECK(rejected(tampered));
+    tampered = good;
+    std::swap(tampered.lineStart.mutableData()[2], tampered.lineStart.mutableData()[3]); // 🔹 смещения убывают
+    CHECK(rejected(tampered));
+    tampered = good;
+    tampered.polygonStart.mutableData()[1] = uint32_t(good.lineCount() + 1); // 🔹 полигон за концом линий
+    CHECK(rejected(tampered));
+    tampered = good;
+    tampered.polygonStart.mutableData()[0] = 1; // 🔹 первый полигон начинается не с нуля
+    CHECK(rejected(tampered));
+
+    std::remove(cache.c_str());
+    std::remove(source.c_str());
+}
+
+TEST(mesh, bvh_validation) {
+    Mesh mesh = makeGrid(16);
+    std::vector<BvhNode> nodes(mesh.bvhNodes.begin(), mesh.bvhNodes.end());
+    CHECK(nodes.size() > 3);
+    CHECK(validateBvh(nodes.data(), nodes.size(), mesh.polygonCount()));
+    CHECK(validateBvh(nullptr, 0, 0));
+
+    // ⚠️ Правый ребёнок совпадает с левым или указывает назад — обход зациклился бы
+    std::vector<BvhNode> broken = nodes;
+    broken[0].right = 1;
+    CHECK(!validateBvh(broken.data(), broken.size(), mesh.polygonCount()));
+    broken = nodes;
+    broken[broken[0].right].right = 1; // 🔹 у сетки 16 × 16 правый ребёнок корня — внутренний узел
+    CHECK(!validateBvh(broken.data(), broken.size(), mesh.polygonCount()));
+
+    // ⚠️ Внутренний узел последним — левого ребёнка нет
+    broken = nodes;
+    broken.back().right = uint32_t(broken.size() - 1);
+    CHECK(!validateBvh(broken.data(), broken.size(), mesh.polygonCount()));
+
+    // ⚠️ Диапазон элементов за концом массива
+    broken = nodes;
+    broken[0].count = uint32_t(mesh.polygonCount() + 1);
+    CHECK(!validateBvh(broken.data(), broken.size(), mesh.polygonCount()));
+
+    // 🔹 Цепочка внутренних узлов глубины depth: левый — следующий, правые — общий лист в конце
+    auto chain = [](int depth) {
+        std::vector<BvhNode> chained(size_t(depth) + 2);
+        for (int i = 0; i < depth; ++i) {
+            chained[i].count = 1;
+            chained[i].right = uint32_t(depth + 1);
+        }
+        chained[depth].count = 1;
+        chained[depth + 1].count = 1;
+        return chained;
+    };
+    std::vector<BvhNode> shallow = chain(BVH_MAX_DEPTH - 1);
+    CHECK(validateBvh(shallow.data(), shallow.size(), 1));
+    std::vector<BvhNode> deep = chain(BVH_MAX_DEPTH);
+    CHECK(!validateBvh(deep.data(), deep.size(), 1));
+}
@@ -0,0 +1,43 @@
+#include <limits>
+
+#include "core.hpp"
+#include "raster.hpp"
+#include "test.hpp"
+
+// 🧱 Растеризатор
+
+TEST(raster, coordinates_clamped_before_int) {
+    CHECK(floorToRange(12.7f, 0, 63) == 12);
+    CHECK(ceilToRange(12.2f, 0, 63) == 13);
+    CHECK(floorToRange(-0.5f, -1, 64) == -1);
+
+    // 🔹 Далеко за экраном и NaN — границы диапазона, а не переполнение int
+    CHECK(floorToRange(-1e30f, -1, 64) == -1);
+    CHECK(ceilToRange(1e30f, -1, 64) == 64);
+    CHECK(floorToRange(std::numeric_limits<float>::infinity(), 0, 639) == 639);
+    CHECK(floorToRange(std::numeric_limits<float>::quiet_NaN(), 0, 639) == 0);
+    CHECK(ceilToRange(-std::numeric_limits<float>::infinity(), 0, 639) == 0);
+}
+
+TEST(raster, far_points_stay_off_buffer) {
+    Framebuffer fb;
+    fb.resize(windowWidth, windowHeight);
+    fb.clear();
+    app.beginFrame(Camera());
+
+    // 🔹 Точка в центре взгляда камеры попадает в буфер, далёкие вбок — отбрасываются без переполнения int
+    Camera camera;
+    app.draw3DPoint(fb, { camera.x, camera.y, 0.0f, 255, 255, 255, 1.0f, 1.0f });
+    size_t lit = 0;
+    for (uint32_t c : fb.color) lit += c != packRGB(0, 0, 0) ? 1 : 0;
+    CHECK(lit == 1);
+
+    fb.clear();
+    const float far = 1e30f;
+    app.draw3DPoint(fb, { far, camera.y, 0.0f, 255, 255, 255, 1.0f, 1.0f });
+    app.draw3DPoint(fb, { -far, -far, 0.0f, 255, 255, 255, 0.5f, 1.0f });
+    app.draw3DPoint(fb, { std::numeric_limits<float>::quiet_NaN(), camera.y, 0.0f, 255, 255, 255, 1.0f, 1.0f });
+    lit = 0;
+    for (uint32_t c : fb.color) lit += c != packRGB(0, 0, 0) ? 1 : 0;
+    CHECK(lit == 0);
+}
@@ -0,0 +1,86 @@
+#include "script.hpp"
+#include "test.hpp"
+
+// 📜 Сценарии: компилятор и регистровая машина
+
+namespace {
+
+// 🔹 Компилирует source с привязками o.a и o.b и прогоняет frames кадров
+struct ScriptRun {
+    float a = 0.0f, b = 0.0f;
+    ScriptBindings bindings;
+    Script script;
+    ScriptError error;
+    bool compiled = false;
+
+    explicit ScriptRun(const std::string& source, int frames = 1, uint32_t budget = SCRIPT_DEFAULT_BUDGET) {
+        bindings.bind("o.a", &a);
+        bindings.bind("o.b", &b);
+        script.budget = budget;
+        compiled = compileScript(source, bindings, script, error);
+        for (int i = 0; compiled && i < frames; ++i)
+            script.run(1.0f / 60.0f, i / 60.0f);
+    }
+};
+
+} // namespace
+
+TEST(script, assignment_reads_old_value) {
+    ScriptRun add("let a = 3 let b = 10 a = b + a o.a = a");
+    CHECK(add.compiled);
+    CHECK_NEAR(add.a, 13.0f, 1e-6f);
+
+    ScriptRun mul("let a = 3 a = 2 * a o.a = a");
+    CHECK_NEAR(mul.a, 6.0f, 1e-6f);
+
+    ScriptRun neg("let a = 3 a = -a + a o.a = a");
+    CHECK_NEAR(neg.a, 0.0f, 1e-6f);
+
+    ScriptRun persistent("var a = 3 a = 2 * a + a o.a = a");
+    CHECK_NEAR(persistent.a, 9.0f, 1e-6f);
+}
+
+TEST(script, var_survives_temporaries) {
+    // ⚠️ временные первого оператора раньше ложились в регистр n
+    ScriptRun run("o.b = 1 + 2 * 3 var n = 0 n += 1 o.a = n", 3);
+    CHECK(run.compiled);
+    CHECK_NEAR(run.b, 7.0f, 1e-6f);
+    CHECK_NEAR(run.a, 3.0f, 1e-6f);
+}
+
+TEST(script, var_after_blocks) {
+    // 🔹 временные и let вложенных блоков не пересекаются с регистрами var
+    ScriptRun run("let x = 1 + 2 if x > 0 { let y = x * 4 o.b = y } var n = 10 n += x o.a = n", 2);
+    CHECK(run.compiled);
+    CHECK_NEAR(run.a, 16.0f, 1e-6f);
+    CHECK_NEAR(run.b, 12.0f, 1e-6f);
+}
+
+TEST(script, init_retried_after_budget) {
+    // 🔹 init не уложился в бюджет первого кадра — тело не выполняется, init повторяется
+    ScriptRun run("var a = 1 + 2 + 3 + 4 o.a = a", 0, 3);
+    CHECK(run.compiled);
+    CHECK(!run.script.run(0.0f, 0.0f));
+    CHECK_NEAR(run.a, 0.0f, 1e-6f);
+
+    run.script.budget = SCRIPT_DEFAULT_BUDGET;
+    CHECK(run.script.run(0.0f, 0.0f));
+    CHECK_NEAR(run.a, 10.0f, 1e-6f);
+}
+
+TEST(script, let_in_var_initializer_rejected) {
+    ScriptRun run("let x = 5 var n = x o.a = n");
+    CHECK(!run.compiled);
+    CHECK(run.error.message.find("'x'") != std::string::npos);
+
+    ScriptRun ok("var x = 5 var n = x + 1 o.a = n");
+    CHECK(ok.compiled);
+    CHECK_NEAR(ok.a, 6.0f, 1e-6f);
+}
+
+TEST(script, while_and_builtins) {
+    ScriptRun run("let r = 300 while r > 100 { r -= 50 } o.a = r o.b = clamp(max(2, 7), 0, 5)");
+    CHECK(run.compiled);
+    CHECK_NEAR(run.a, 100.0f, 1e-6f);
+    CHECK_NEAR(run.b, 5.0f, 1e-6f);
+}
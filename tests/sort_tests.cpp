@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+#include "radix_sort.hpp"
+#include "thread_pool.hpp"
+#include "test.hpp"
+
+// 🔢 Поразрядная сортировка и порядок с учётом прошлого кадра
+
+namespace {
+
+// 🔹 Эталон: устойчивая сортировка индексов по ключу
+std::vector<uint32_t> referenceOrder(const std::vector<uint32_t>& keys) {
+    std::vector<uint32_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+    return order;
+}
+
+std::vector<uint32_t> randomKeys(size_t count, uint32_t mask, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::vector<uint32_t> keys(count);
+    for (uint32_t& key : keys) key = random() & mask;
+    return keys;
+}
+
+} // namespace
+
+TEST(sort, radix_matches_stable_sort) {
+    ThreadPool pool(4);
+    std::vector<uint32_t> keysScratch, valuesScratch;
+
+    // 🔹 Размеры: пусто, один кусок и несколько кусков на потоки; ключи с повторами и во все 32 бита
+    const size_t sizes[] = { 0, 1, 7, 1000, 100000 };
+    const struct { uint32_t mask; unsigned bits; } widths[] = { { 0xFF, 8 }, { 0xFFFFFF, 24 }, { 0xFFFFFFFF, 32 }, { 0x3F, 24 } };
+    for (size_t count : sizes) {
+        for (const auto& width : widths) {
+            std::vector<uint32_t> original = randomKeys(count, width.mask, uint32_t(count * 31 + width.bits));
+            std::vector<uint32_t> keys = original;
+            std::vector<uint32_t> values(count);
+            std::iota(values.begin(), values.end(), 0u);
+
+            radixSortPairs(keys, values, keysScratch, valuesScratch, width.bits, pool);
+            std::vector<uint32_t> expected = referenceOrder(original);
+            CHECK(values == expected);
+            CHECK(std::is_sorted(keys.begin(), keys.end()));
+            bool pairsKept = true;
+            for (size_t i = 0; i < count; ++i) pairsKept = pairsKept && keys[i] == original[values[i]];
+            CHECK(pairsKept);
+        }
+    }
+
+    // 🔹 Все ключи одинаковые — все проходы пропускаются, порядок исходный
+    std::vector<uint32_t> same(50000, 0xABCDEFu), values(50000);
+    std::iota(values.begin(), values.end(), 0u);
+    radixSortPairs(same, values, keysScratch, valuesScratch, 24, pool);
+    CHECK(std::is_sorted(values.begin(), values.end()));
+}
+
+TEST(sort, coherent_reuses_previous_order) {
+    ThreadPool pool(4);
+    CoherentSort sorter;
+
+    std::vector<uint32_t> keys = randomKeys(5000, 0xFFFFFF, 7);
+    sorter.sort(keys.data(), keys.size(), 24, pool);
+    CHECK(!sorter.reused());
+    CHECK(sorter.order() == referenceOrder(keys));
+
+    // 🎞️ Чуть сдвинутая глубина — прошлый порядок досортировывается вставками
+    std::mt19937 random(11);
+    for (size_t i = 0; i < keys.size(); i += 50) keys[i] = std::min<uint32_t>(0xFFFFFF, keys[i] + (random() & 0xFF));
+    std::vector<uint32_t> previous = sorter.order();
+    sorter.sort(keys.data(), keys.size(), 24, pool);
+    CHECK(sorter.reused());
+    std::vector<uint32_t> order = sorter.order();
+    CHECK(std::is_sorted(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; }));
+    std::sort(previous.begin(), previous.end());
+    std::sort(order.begin(), order.end());
+    CHECK(order == previous); // 🔹 перестановка тех же индексов
+
+    // 🔹 Порядок перевернулся — перестановок слишком много, сортировка с нуля
+    for (uint32_t& key : keys) key = 0xFFFFFF - key;
+    sorter.sort(keys.data(), keys.size(), 24, pool);
+    CHECK(!sorter.reused());
+    order = sorter.order();
+    CHECK(std::is_sorted(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; }));
+
+    // 🔹 Другое число элементов — тоже с нуля
+    keys.resize(4000);
+    sorter.sort(keys.data(), keys.size(), 24, pool);
+    CHECK(!sorter.reused());
+    CHECK(sorter.order().size() == 4000);
+    CHECK(std::is_sorted(sorter.order().begin(), sorter.order().end(),
+                         [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; }));
+}
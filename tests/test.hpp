@@ -0,0 +1,45 @@
+#pragma once
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+// 🧪 Минимальный раннер без сторонних библиотек: TEST регистрирует случай,
+// CHECK отмечает провал и продолжает — так за один прогон видны все расхождения.
+
+struct TestCase {
+    const char* group;
+    const char* name;
+    std::function<void()> body;
+};
+
+std::vector<TestCase>& testCases();
+void reportFailure(const char* file, int line, const std::string& message);
+
+struct TestRegistrar {
+    TestRegistrar(const char* group, const char* name, std::function<void()> body) {
+        testCases().push_back({ group, name, std::move(body) });
+    }
+};
+
+#define TEST_CONCAT_IMPL(a, b) a##b
+#define TEST_CONCAT(a, b) TEST_CONCAT_IMPL(a, b)
+
+// 🔹 TEST(группа, имя) { ... } — группа совпадает с именем теста в ctest
+#define TEST(group, name) \
+    static void TEST_CONCAT(test_, TEST_CONCAT(group, TEST_CONCAT(_, name)))(); \
+    static TestRegistrar TEST_CONCAT(registrar_, TEST_CONCAT(group, TEST_CONCAT(_, name)))( \
+        #group, #name, TEST_CONCAT(test_, TEST_CONCAT(group, TEST_CONCAT(_, name)))); \
+    static void TEST_CONCAT(test_, TEST_CONCAT(group, TEST_CONCAT(_, name)))()
+
+#define CHECK(condition) \
+    do { if (!(condition)) reportFailure(__FILE__, __LINE__, #condition); } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+    do { \
+        double a_ = double(actual), e_ = double(expected); \
+        if (!(std::fabs(a_ - e_) <= double(tolerance))) \
+            reportFailure(__FILE__, __LINE__, std::string(#actual) + " = " + std::to_string(a_) + \
+                ", ожидалось " + std::to_string(e_)); \
+    } while (0)
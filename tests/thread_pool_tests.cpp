@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include "thread_pool.hpp"
+#include "test.hpp"
+
+// 🧵 Пул потоков: задачи, кража и parallelFor
+
+namespace {
+
+// ⏳ Задачи не ждут друг друга — ждёт только тест, снаружи пула
+bool waitFor(const std::atomic<int>& counter, int expected) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (counter.load() < expected) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(thread_pool, submit_runs_every_task) {
+    ThreadPool pool(4);
+    std::atomic<int> done{ 0 };
+    for (int i = 0; i < 2000; ++i)
+        pool.submit([&] { done.fetch_add(1); });
+    CHECK(waitFor(done, 2000));
+    CHECK(done.load() == 2000);
+
+    // 🔹 Один поток — задача выполняется сразу на вызывающем
+    ThreadPool single(1);
+    int inline_ = 0;
+    single.submit([&] { ++inline_; });
+    CHECK(inline_ == 1);
+}
+
+TEST(thread_pool, idle_workers_steal) {
+    ThreadPool pool(4);
+    const int children = 64;
+    std::atomic<int> done{ 0 };
+    std::mutex mutex;
+    std::set<std::thread::id> runners;
+
+    // 🔹 Задачи из задачи пула ложатся в очередь одного рабочего — остальным достаются только кражей
+    pool.submit([&] {
+        for (int i = 0; i < children; ++i) {
+            pool.submit([&] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    runners.insert(std::this_thread::get_id());
+                }
+                done.fetch_add(1);
+            });
+        }
+    });
+    CHECK(waitFor(done, children));
+    std::lock_guard<std::mutex> lock(mutex);
+    CHECK(runners.size() > 1);
+}
+
+TEST(thread_pool, parallel_for_covers_range) {
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> hits(10000);
+    for (int round = 0; round < 3; ++round)
+        pool.parallelFor(hits.size(), [&](size_t i) { hits[i].fetch_add(1); });
+    CHECK(std::all_of(hits.begin(), hits.end(), [](const std::atomic<int>& h) { return h.load() == 3; }));
+
+    // 🔹 parallelFor, пока рабочие заняты фоновыми задачами, не ждёт их
+    std::atomic<int> background{ 0 };
+    for (int i = 0; i < 3; ++i)
+        pool.submit([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            background.fetch_add(1);
+        });
+    std::atomic<int> sum{ 0 };
+    pool.parallelFor(100, [&](size_t i) { sum.fetch_add(int(i)); });
+    CHECK(sum.load() == 4950);
+    CHECK(waitFor(background, 3));
+}